@@ -0,0 +1,40 @@
+#include "ActorRuntime.h"
+
+#include <cassert>
+
+#include "ActorState.h"
+#include "WorldState.h"
+
+namespace ffw {
+
+  void ActorRuntime::push_back(const ActorState& actor)
+  {
+    positions.push_back(actor.position);
+    floors.push_back(actor.floor);
+    types.push_back(actor.feature.type());
+  }
+
+  void ActorRuntime::erase(uint32_t first, uint32_t count)
+  {
+    assert(first + count <= size());
+    positions.erase(positions.begin() + first, positions.begin() + first + count);
+    floors.erase(floors.begin() + first, floors.begin() + first + count);
+    types.erase(types.begin() + first, types.begin() + first + count);
+  }
+
+  void ActorRuntime::bind(const WorldState& state)
+  {
+    positions.clear();
+    floors.clear();
+    types.clear();
+
+    positions.reserve(state.actors.size());
+    floors.reserve(state.actors.size());
+    types.reserve(state.actors.size());
+
+    for (const ActorState& actor : state.actors) {
+      push_back(actor);
+    }
+  }
+
+}
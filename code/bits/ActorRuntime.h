@@ -0,0 +1,41 @@
+#ifndef FFW_ACTOR_RUNTIME_H
+#define FFW_ACTOR_RUNTIME_H
+
+#include <cstdint>
+
+#include <vector>
+
+#include <gf2/core/Vec2.h>
+
+#include "ActorData.h"
+#include "MapFloor.h"
+
+namespace ffw {
+  struct ActorState;
+  struct WorldState;
+
+  /*
+   * The hot fields of the actors in dense arrays, in the same order as
+   * WorldState::actors, for the loops on all the actors. WorldModel keeps
+   * them in sync with the actors.
+   */
+
+  struct ActorRuntime {
+    std::vector<gf::Vec2I> positions;
+    std::vector<Floor> floors;
+    std::vector<ActorType> types;
+
+    std::size_t size() const
+    {
+      return positions.size();
+    }
+
+    void push_back(const ActorState& actor);
+    void erase(uint32_t first, uint32_t count);
+
+    void bind(const WorldState& state);
+  };
+
+}
+
+#endif // FFW_ACTOR_RUNTIME_H
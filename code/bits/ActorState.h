@@ -3,6 +3,8 @@
 
 #include <cstdint>
 
+#include <string>
+
 #include <gf2/core/Color.h>
 #include <gf2/core/Fixed.h>
 #include <gf2/core/TaggedVariant.h>
@@ -27,7 +29,14 @@ namespace ffw {
 
   using Stat = gf::Fixed<int32_t, 16>;
 
-  struct HumanFeature {
+  /*
+   * The actors only contain the data that is needed in the loops on all the
+   * actors (scheduling, rendering, sorting). The rest of the data of the
+   * humans is in a side table, see WorldState::humans. The positions, floors
+   * and types are also in dense arrays at runtime, see ActorRuntime.
+   */
+
+  struct HumanState {
     std::string name;
     Gender gender;
     MonthDay birthday;
@@ -42,13 +51,27 @@ namespace ffw {
     Stat intensity;
     Stat precision;
     Stat endurance;
+    // items
+    InventoryState inventory;
+    WeaponItemState weapon;
+    InventoryItemState ammunition;
+  };
+
+  template<typename Archive>
+  Archive& operator|(Archive& ar, gf::MaybeConst<HumanState, Archive>& state)
+  {
+    return ar | state.name | state.gender | state.birthday | state.age | state.health | state.force | state.dexterity | state.constitution | state.luck | state.intensity | state.precision | state.endurance | state.inventory | state.weapon | state.ammunition;
+  }
+
+  struct HumanFeature {
+    uint32_t human = NoIndex; // index in WorldState::humans
     uint32_t mounting = NoIndex;
   };
 
   template<typename Archive>
   Archive& operator|(Archive& ar, gf::MaybeConst<HumanFeature, Archive>& feature)
   {
-    return ar | feature.name | feature.gender | feature.birthday | feature.age | feature.health | feature.force | feature.dexterity | feature.constitution | feature.luck | feature.intensity | feature.precision | feature.endurance | feature.mounting;
+    return ar | feature.human | feature.mounting;
   }
 
   struct AnimalFeature {
@@ -71,16 +94,12 @@ namespace ffw {
     gf::Vec2I position;
     Floor floor = Floor::Ground;
     ActorFeature feature;
-    InventoryState inventory;
-
-    WeaponItemState weapon;
-    InventoryItemState ammunition;
   };
 
   template<typename Archive>
   Archive& operator|(Archive& ar, gf::MaybeConst<ActorState, Archive>& state)
   {
-    return ar | state.data | state.position | state.floor | state.feature | state.inventory | state.weapon | state.ammunition;
+    return ar | state.data | state.position | state.floor | state.feature;
   }
 
 }
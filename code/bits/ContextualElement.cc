@@ -1,6 +1,7 @@
 #include "ContextualElement.h"
 
 #include "FarFarWest.h"
+#include "NetworkRuntime.h"
 #include "Settings.h"
 
 namespace ffw {
@@ -17,11 +18,46 @@ namespace ffw {
   void ContextualElement::render(gf::Console& console)
   {
     auto* state = m_game->state();
+    auto* runtime = m_game->runtime();
 
     gf::ConsoleStyle contextual_box_style;
     contextual_box_style.color.foreground = gf::Gray;
     console.draw_frame(ContextualBox, contextual_box_style);
 
+    // timetable of a station near the hero
+
+    const ActorState& hero = state->hero();
+
+    if (hero.floor != Floor::Ground) {
+      return;
+    }
+
+    const uint32_t station_index = runtime->network.compute_station_near(state->network.stations, hero.position);
+
+    if (station_index == NoIndex) {
+      return;
+    }
+
+    const TrainStop stop = runtime->network.compute_next_departure(station_index, state->current_date);
+
+    gf::Vec2I position = ContextualBoxPosition + 1;
+    console.print(position, gf::ConsoleAlignment::Left, m_game->style(), "<style=character>Railway station</>");
+    position.y += 2;
+
+    if (state->current_date < stop.arrival) {
+      console.print(position, gf::ConsoleAlignment::Left, m_game->style(), "Next train: <style=date>{}</>", stop.arrival.to_string_hours_minutes());
+    } else {
+      // the train is stopped in the station, its arrival is already past
+      console.print(position, gf::ConsoleAlignment::Left, m_game->style(), "Train in the station");
+    }
+
+    ++position.y;
+    console.print(position, gf::ConsoleAlignment::Left, m_game->style(), "Departure: <style=date>{}</>", stop.departure.to_string_hours_minutes());
+
+    if (stop.next_station != station_index) {
+      ++position.y;
+      console.print(position, gf::ConsoleAlignment::Left, m_game->style(), "Next stop: <style=date>{}</>", stop.next_arrival.to_string_hours_minutes());
+    }
   }
 
 }
@@ -3,8 +3,10 @@
 #include <gf2/core/Flags.h>
 #include <gf2/core/PathFinding.h>
 
+#include "ActorRuntime.h"
 #include "ActorState.h"
 #include "FarFarWest.h"
+#include "Logging.h"
 #include "MapRuntime.h"
 #include "MapState.h"
 #include "Settings.h"
@@ -36,6 +38,8 @@ namespace ffw {
       { "go_north_east"_id, gf::Orientation::NorthEast, gf::Scancode::Numpad9, gf::Scancode::Unknown },
     };
 
+    constexpr std::string_view SchedulerStatsFile = "scheduler_stats.json";
+
   }
 
   ControlScene::ControlScene(FarFarWest* game)
@@ -80,6 +84,10 @@ namespace ffw {
 
     settings.actions.emplace("mount"_id, gf::instantaneous_action().add_keycode_control(gf::Keycode::M));
     settings.actions.emplace("reload"_id, gf::instantaneous_action().add_keycode_control(gf::Keycode::R));
+    settings.actions.emplace("wait_train"_id, gf::instantaneous_action().add_keycode_control(gf::Keycode::W));
+
+    settings.actions.emplace("scheduler_stats"_id, gf::instantaneous_action().add_scancode_control(gf::Scancode::F3));
+    settings.actions.emplace("dump_scheduler_stats"_id, gf::instantaneous_action().add_scancode_control(gf::Scancode::F4));
 
     settings.actions.emplace("escape"_id, gf::instantaneous_action().add_scancode_control(gf::Scancode::Escape));
     settings.actions.emplace("go"_id, gf::instantaneous_action().add_mouse_button_control(gf::MouseButton::Left));
@@ -91,13 +99,21 @@ namespace ffw {
   {
     const WorldState* state = m_game->state();
 
+    using namespace gf::literals;
+
+    if (m_action_group.active("scheduler_stats"_id)) {
+      m_game->primary.toggle_scheduler_stats();
+    }
+
+    if (m_action_group.active("dump_scheduler_stats"_id)) {
+      m_game->runtime()->scheduler_stats.save_to_file(SchedulerStatsFile);
+    }
+
     if (!state->scheduler.is_hero_turn()) {
       m_action_group.reset();
       return;
     }
 
-    using namespace gf::literals;
-
     WorldRuntime* runtime = m_game->runtime();
     runtime->hero.action = {};
 
@@ -136,6 +152,10 @@ namespace ffw {
       runtime->hero.reload();
     }
 
+    if (m_action_group.active("wait_train"_id)) {
+      runtime->hero.wait_train();
+    }
+
     if (m_action_group.active("minimap"_id)) {
       m_game->pop_all_scenes();
       m_game->push_scene(&m_game->minimap);
@@ -181,11 +201,13 @@ namespace ffw {
 
     const FloorMap& runtime_map = runtime->map.from_floor(floor);
 
-    if (runtime_map.reverse(target).empty() && runtime_map.background(target).walkable()) {
+    const bool train_at_target = floor == Floor::Ground && runtime->network.compute_train_at(state->network.trains, target, state->current_date) != NoIndex;
+
+    if (runtime_map.reverse(target).empty() && !train_at_target && runtime_map.background(target).walkable()) {
       using gf::operators::operator|;
 
       if (runtime->hero.moves.empty()) {
-        gf::Log::debug("computing path to {},{}", target.x, target.y);
+        FFW_LOG_DEBUG("computing path to {},{}", target.x, target.y);
 
         m_computed_path = gf::compute_route_astar(runtime_map.background, runtime->map.grid, state->hero().position, target, [](gf::Vec2I position, gf::Vec2I neighbor) {
           // TODO: take the scenery into account
@@ -198,7 +220,7 @@ namespace ffw {
           return 1.0f;
         }, gf::CellNeighborQuery::Valid | gf::CellNeighborQuery::Diagonal);
 
-        gf::Log::debug("path computed");
+        FFW_LOG_DEBUG("path computed");
       }
 
       if (!m_computed_path.empty()) {
@@ -236,7 +258,7 @@ namespace ffw {
       return;
     }
 
-    gf::Log::debug("update grid");
+    FFW_LOG_DEBUG("update grid");
 
     const WorldRuntime* runtime = m_game->runtime();
     const Floor hero_floor = state->hero().floor;
@@ -244,33 +266,26 @@ namespace ffw {
 
     m_grid = floor_map.background;
 
-    for (const ActorState& actor : state->actors) {
-      if (actor.floor == hero_floor) {
-        m_grid(actor.position).properties.set(RuntimeMapCellProperty::Walkable);
+    const ActorRuntime& actors = runtime->actors;
+
+    for (uint32_t actor_index = 0; actor_index < actors.size(); ++actor_index) {
+      if (actors.floors[actor_index] == hero_floor) {
+        m_grid(actors.positions[actor_index]).properties.set(RuntimeMapCellProperty::Walkable);
       }
     }
 
     if (hero_floor == Floor::Ground) {
       for (const TrainState& train : state->network.trains) {
-        uint32_t offset = 0;
-
-        for (uint32_t k = 0; k < TrainLength; ++k) {
-          const uint32_t index = runtime->network.next_position(train.railway_index, offset);
-          assert(index < runtime->network.railway.size());
-          const gf::Vec2I position = runtime->network.railway[index];
-
+        const uint32_t railway_index = runtime->network.compute_train_index(train, state->current_date);
 
+        runtime->network.for_each_train_part(railway_index, [&]([[maybe_unused]] uint32_t part, gf::Vec2I position) {
           for (int32_t i = -1; i <= 1; ++i) {
             for (int32_t j = -1; j <= 1; ++j) {
               const gf::Vec2I neighbor = { i, j };
-              const gf::Vec2I neighbor_position = position + neighbor;
-
-              m_grid(neighbor_position).properties.set(RuntimeMapCellProperty::Walkable);
+              m_grid(position + neighbor).properties.set(RuntimeMapCellProperty::Walkable);
             }
           }
-
-          offset += 3;
-        }
+        });
       }
     }
 
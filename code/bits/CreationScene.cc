@@ -77,7 +77,12 @@ namespace ffw {
     m_time += time;
 
     if (m_game->world_creation_finished()) {
-      m_game->start_world();
+      if (m_game->world_creation_failed()) {
+        // back to the choice of the adventure, a new world has another seed
+        m_game->replace_scene(&m_game->kickoff);
+      } else {
+        m_game->start_world();
+      }
     }
   }
 
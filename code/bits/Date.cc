@@ -3,8 +3,6 @@
 #include <cstdint>
 #include <ctime>
 
-#include <tuple>
-
 #include <fmt/chrono.h>
 
 namespace ffw {
@@ -16,22 +14,41 @@ namespace ffw {
     constexpr uint8_t DaysInWeek = 7;
     constexpr uint8_t MonthsInYear = 12;
 
+    constexpr uint16_t DaysInYear = 365;
+    constexpr uint32_t SecondsInDay = uint32_t(SecondsInMinute) * MinutesInHour * HoursInDay;
+
     constexpr uint8_t DaysInMonth[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    constexpr uint16_t DaysBeforeMonth[12] = { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 };
 
     uint8_t days_in_month(Month month)
     {
       return DaysInMonth[uint8_t(month)];
     }
 
+    /*
+     * The epoch is a Monday, the 1st of January of year 0. There are no leap
+     * years, so the calendar can be computed directly from the timestamp.
+     */
+
     std::tm to_tm(const Date& date)
     {
+      const uint64_t days = date.timestamp / SecondsInDay;
+      const uint32_t seconds_in_day = static_cast<uint32_t>(date.timestamp % SecondsInDay);
+      const uint16_t day_in_year = static_cast<uint16_t>(days % DaysInYear);
+
+      uint8_t month = MonthsInYear - 1;
+
+      while (DaysBeforeMonth[month] > day_in_year) {
+        --month;
+      }
+
       std::tm tm = {};
-      tm.tm_sec = date.seconds;
-      tm.tm_min = date.minutes;
-      tm.tm_hour = date.hours;
-      tm.tm_mday = date.day;
-      tm.tm_mon = uint8_t(date.month);
-      tm.tm_wday = uint8_t(date.weekday);
+      tm.tm_sec = static_cast<int>(seconds_in_day % SecondsInMinute);
+      tm.tm_min = static_cast<int>(seconds_in_day / SecondsInMinute % MinutesInHour);
+      tm.tm_hour = static_cast<int>(seconds_in_day / (SecondsInMinute * MinutesInHour));
+      tm.tm_mday = day_in_year - DaysBeforeMonth[month] + 1;
+      tm.tm_mon = month;
+      tm.tm_wday = static_cast<int>(days % DaysInWeek);
       return tm;
     }
 
@@ -49,52 +66,25 @@ namespace ffw {
     return fmt::format("{:%R %p}", tm);
   }
 
-  void Date::add_seconds(uint16_t duration_in_seconds)
-  {
-    seconds += duration_in_seconds;
-
-    if (seconds >= SecondsInMinute) {
-      minutes += seconds / SecondsInMinute;
-      seconds %= SecondsInMinute;
-    }
-
-    if (minutes >= MinutesInHour) {
-      hours += static_cast<uint8_t>(minutes / MinutesInHour);
-      minutes %= MinutesInHour;
-    }
-
-    while (hours >= HoursInDay) {
-      ++day;
-      weekday = WeekDay{uint8_t((uint8_t(weekday) + 1) % DaysInWeek)};
-
-      if (day > days_in_month(month)) {
-        day = 1;
-        month = Month{uint8_t((uint8_t(month) + 1) % MonthsInYear)};
-
-        if (month == Month::Jan) {
-          // it's a new year
-          ++year;
-        }
-      }
-
-      hours -= HoursInDay;
-    }
-  }
-
   Date Date::generate_random(gf::Random* random)
   {
-    Date date = {};
+    const Month month = Month{ random->compute_uniform_integer(MonthsInYear) };
+    uint8_t day = random->compute_uniform_integer(days_in_month(month)); ++day;
 
-    date.year = 0; // not used publicly so it's ok to set it to 0
-    date.month = Month{ random->compute_uniform_integer(MonthsInYear) };
-    date.day = random->compute_uniform_integer(days_in_month(date.month)); ++date.day;
+    const WeekDay weekday = WeekDay { random->compute_uniform_integer(DaysInWeek) };
 
-    date.weekday = WeekDay { random->compute_uniform_integer(DaysInWeek) };
+    const uint8_t hours = 12;
+    const uint16_t minutes = random->compute_uniform_integer(MinutesInHour);
+    const uint16_t seconds = random->compute_uniform_integer(SecondsInMinute);
 
-    date.hours = 12;
-    date.minutes = random->compute_uniform_integer(MinutesInHour);
-    date.seconds = random->compute_uniform_integer(SecondsInMinute);
+    // the year is not used publicly, it is chosen so that the week day matches (365 = 52 * 7 + 1)
 
+    const uint16_t day_in_year = DaysBeforeMonth[uint8_t(month)] + day - 1;
+    const uint8_t year = static_cast<uint8_t>((DaysInWeek + uint8_t(weekday) - day_in_year % DaysInWeek) % DaysInWeek);
+    const uint64_t days = uint64_t(year) * DaysInYear + day_in_year;
+
+    Date date;
+    date.timestamp = ((days * HoursInDay + hours) * MinutesInHour + minutes) * SecondsInMinute + seconds;
     return date;
   }
 
@@ -105,14 +95,4 @@ namespace ffw {
     return { month, day };
   }
 
-  bool operator<(const Date& lhs, const Date& rhs)
-  {
-    return std::tie(lhs.year, lhs.month, lhs.day, lhs.hours, lhs.minutes, lhs.seconds) < std::tie(rhs.year, rhs.month, rhs.day, rhs.hours, rhs.minutes, rhs.seconds);
-  }
-
-  bool operator==(const Date& lhs, const Date& rhs)
-  {
-    return std::tie(lhs.year, lhs.month, lhs.day, lhs.hours, lhs.minutes, lhs.seconds) == std::tie(rhs.year, rhs.month, rhs.day, rhs.hours, rhs.minutes, rhs.seconds);
-  }
-
 }
@@ -35,29 +35,38 @@ namespace ffw {
   };
 
   struct Date {
-    uint8_t year;
-    Month month;
-    uint8_t day;
-    WeekDay weekday;
-    uint8_t hours;
-    uint16_t minutes;
-    uint16_t seconds;
+    uint64_t timestamp = 0; // seconds since the beginning of the epoch, the calendar is computed from it
 
     std::string to_string() const;
     std::string to_string_hours_minutes() const;
 
-    void add_seconds(uint16_t duration_in_seconds);
+    void add_seconds(uint16_t duration_in_seconds)
+    {
+      timestamp += duration_in_seconds;
+    }
+
+    uint64_t as_seconds() const
+    {
+      return timestamp;
+    }
 
     static Date generate_random(gf::Random* random);
   };
 
-  bool operator<(const Date& lhs, const Date& rhs);
-  bool operator==(const Date& lhs, const Date& rhs);
+  inline bool operator<(const Date& lhs, const Date& rhs)
+  {
+    return lhs.timestamp < rhs.timestamp;
+  }
+
+  inline bool operator==(const Date& lhs, const Date& rhs)
+  {
+    return lhs.timestamp == rhs.timestamp;
+  }
 
   template<typename Archive>
   Archive& operator|(Archive& ar, gf::MaybeConst<Date, Archive>& date)
   {
-    return ar | date.year | date.month | date.day | date.weekday | date.hours | date.minutes | date.seconds;
+    return ar | date.timestamp;
   }
 
   struct MonthDay {
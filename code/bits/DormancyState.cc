@@ -0,0 +1,46 @@
+#include "DormancyState.h"
+
+#include <cassert>
+
+#include <algorithm>
+
+namespace ffw {
+
+  void DormancyState::park(gf::Vec2I position, uint32_t index, Date date)
+  {
+    const gf::Vec2I chunk = to_dormancy_chunk(position);
+    assert(chunks.valid(chunk));
+    chunks(chunk).push_back({ index, date });
+    ++count;
+  }
+
+  std::vector<DormantActor> DormancyState::wake(gf::Vec2I chunk)
+  {
+    if (!chunks.valid(chunk) || chunks(chunk).empty()) {
+      return {};
+    }
+
+    std::vector<DormantActor> actors;
+    std::swap(actors, chunks(chunk));
+    assert(actors.size() <= count);
+    count -= static_cast<uint32_t>(actors.size());
+    return actors;
+  }
+
+  bool DormancyState::contains(gf::Vec2I position, uint32_t index) const
+  {
+    const std::vector<DormantActor>& actors = chunks(to_dormancy_chunk(position));
+    return std::any_of(actors.begin(), actors.end(), [index](const DormantActor& actor) { return actor.index == index; });
+  }
+
+  void DormancyState::remove(gf::Vec2I position, uint32_t index)
+  {
+    std::vector<DormantActor>& actors = chunks(to_dormancy_chunk(position));
+    auto iterator = std::find_if(actors.begin(), actors.end(), [index](const DormantActor& actor) { return actor.index == index; });
+    assert(iterator != actors.end());
+    actors.erase(iterator);
+    assert(count > 0);
+    --count;
+  }
+
+}
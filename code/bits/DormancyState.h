@@ -0,0 +1,71 @@
+#ifndef FFW_DORMANCY_STATE_H
+#define FFW_DORMANCY_STATE_H
+
+#include <cstdint>
+
+#include <vector>
+
+#include <gf2/core/Array2D.h>
+#include <gf2/core/TypeTraits.h>
+#include <gf2/core/Vec2.h>
+
+#include "Date.h"
+#include "Settings.h"
+
+namespace ffw {
+
+  /*
+   * Actors that are far from the hero are removed from the scheduler and
+   * parked in the chunk where they are. They are woken up when the hero
+   * comes close to their chunk.
+   */
+
+  inline constexpr int32_t DormancyChunkSize = 32;
+  inline constexpr gf::Vec2I DormancyChunkCount = WorldSize / DormancyChunkSize;
+
+  constexpr gf::Vec2I to_dormancy_chunk(gf::Vec2I position)
+  {
+    return position / DormancyChunkSize;
+  }
+
+  struct DormantActor {
+    uint32_t index;
+    Date date; // date of the task when the actor was parked
+  };
+
+  template<typename Archive>
+  Archive& operator|(Archive& ar, gf::MaybeConst<DormantActor, Archive>& actor)
+  {
+    return ar | actor.index | actor.date;
+  }
+
+  struct DormancyState {
+    gf::Array2D<std::vector<DormantActor>> chunks = gf::Array2D<std::vector<DormantActor>>(DormancyChunkCount);
+    uint32_t count = 0;
+
+    void park(gf::Vec2I position, uint32_t index, Date date);
+    std::vector<DormantActor> wake(gf::Vec2I chunk);
+
+    bool contains(gf::Vec2I position, uint32_t index) const;
+    void remove(gf::Vec2I position, uint32_t index);
+
+    template<typename Function>
+    void update_indices(Function function)
+    {
+      for (std::vector<DormantActor>& actors : chunks) {
+        for (DormantActor& actor : actors) {
+          function(actor.index);
+        }
+      }
+    }
+  };
+
+  template<typename Archive>
+  Archive& operator|(Archive& ar, gf::MaybeConst<DormancyState, Archive>& state)
+  {
+    return ar | state.chunks | state.count;
+  }
+
+}
+
+#endif // FFW_DORMANCY_STATE_H
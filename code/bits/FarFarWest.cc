@@ -1,6 +1,8 @@
 #include "FarFarWest.h"
 
 #include <filesystem>
+#include <optional>
+#include <utility>
 
 #include <fmt/std.h>
 
@@ -100,6 +102,7 @@ namespace ffw {
   void FarFarWest::create_world(AdventureChoice choice)
   {
     m_async_world_finished = false;
+    m_async_world_failed = false;
 
     m_async_world = std::async(std::launch::async, [&,choice]() {
       m_step.store(WorldGenerationStep::File);
@@ -111,7 +114,14 @@ namespace ffw {
           std::filesystem::remove(m_savefile);
         }
 
-        m_model.state = generate_world(m_random, m_step);
+        std::optional<WorldState> state = generate_world(generate_world_seed(m_random), m_step);
+
+        if (!state) {
+          m_async_world_failed = true;
+          return;
+        }
+
+        m_model.state = std::move(*state);
       } else {
         assert(has_save());
         gf::Clock clock;
@@ -135,6 +145,11 @@ namespace ffw {
     return m_async_world_finished;
   }
 
+  bool FarFarWest::world_creation_failed() const
+  {
+    return m_async_world_failed;
+  }
+
   WorldGenerationStep FarFarWest::world_creation_step()
   {
     return m_step.load();
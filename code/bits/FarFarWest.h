@@ -62,6 +62,7 @@ namespace ffw {
 
     void create_world(AdventureChoice choice);
     bool world_creation_finished();
+    bool world_creation_failed() const;
     WorldGenerationStep world_creation_step();
 
     void start_world();
@@ -95,6 +96,7 @@ namespace ffw {
     WorldModel m_model;
     std::future<void> m_async_world;
     bool m_async_world_finished = false;
+    bool m_async_world_failed = false;
 
     std::atomic<WorldGenerationStep> m_step;
 
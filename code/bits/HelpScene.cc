@@ -34,6 +34,7 @@ namespace ffw {
     constexpr std::string_view ActionHelpText = R"help(
 <style=key>M</>: Mount/Dismount an animal
 <style=key>R</>: Reload a weapon
+<style=key>W</>: Wait for the next train at a station
 )help";
 
     constexpr gf::RectI GeneralHelpBox = gf::RectI::from_position_size({ 48, 1 }, { 47, 52 });
@@ -44,6 +45,8 @@ namespace ffw {
 <style=key>Tab</>: Show minimap
 <style=key>Space</>: Select an option
 <style=key>Escape</>: Quit the game
+<style=key>F3</>: Show scheduler stats
+<style=key>F4</>: Save scheduler stats
 <style=context>In help mode</>:
 <style=key>H</>: Quit help
 <style=context>In minimap mode</>:
@@ -80,7 +80,7 @@ namespace ffw {
     position.y += 2;
 
     const ActorState& hero = state->hero();
-    const HumanFeature& feature = hero.feature.from<ActorType::Human>();
+    const HumanState& feature = state->human(hero);
 
     console.print(position, gf::ConsoleAlignment::Left, m_game->style(), "<style=hero>{}</>", feature.name);
     ++position.y;
@@ -120,34 +120,34 @@ namespace ffw {
     console.print(position, gf::ConsoleAlignment::Left, m_game->style(), "<style=weapon>Weapon</>:"); // put the type of the weapon here?
     ++position.y;
 
-    if (hero.weapon.data) {
-      console.print(position, gf::ConsoleAlignment::Left, m_game->style(), hero.weapon.data->label.tag);
+    if (feature.weapon.data) {
+      console.print(position, gf::ConsoleAlignment::Left, m_game->style(), feature.weapon.data->label.tag);
     } else {
       console.print(position, gf::ConsoleAlignment::Left, m_game->style(), "-");
     }
 
     ++position.y;
 
-    if (hero.ammunition.data) {
-      assert(hero.ammunition.data->feature.type() == ItemType::Ammunition);
-      const AmmunitionDataFeature& ammunition = hero.ammunition.data->feature.from<ItemType::Ammunition>();
+    if (feature.ammunition.data) {
+      assert(feature.ammunition.data->feature.type() == ItemType::Ammunition);
+      const AmmunitionDataFeature& ammunition = feature.ammunition.data->feature.from<ItemType::Ammunition>();
       console.print(position, gf::ConsoleAlignment::Left, m_game->style(), "<style=weapon>Ammunitions</>: .{}", ammunition.caliber); // only for firearms
       ++position.y;
 
-      assert(hero.weapon.data->feature.type() == ItemType::Firearm);
-      const FirearmDataFeature& firearm = hero.weapon.data->feature.from<ItemType::Firearm>();
+      assert(feature.weapon.data->feature.type() == ItemType::Firearm);
+      const FirearmDataFeature& firearm = feature.weapon.data->feature.from<ItemType::Firearm>();
 
       std::string cartridges;
 
-      for (int8_t i = 0; i < hero.weapon.cartridges; ++i) {
+      for (int8_t i = 0; i < feature.weapon.cartridges; ++i) {
         cartridges += "•";
       }
 
-      for (int8_t i = hero.weapon.cartridges; i < firearm.capacity; ++i) {
+      for (int8_t i = feature.weapon.cartridges; i < firearm.capacity; ++i) {
         cartridges += "○";
       }
 
-      console.print(position, gf::ConsoleAlignment::Left, m_game->style(), "{} [{}]", cartridges, hero.ammunition.count);
+      console.print(position, gf::ConsoleAlignment::Left, m_game->style(), "{} [{}]", cartridges, feature.ammunition.count);
     } else {
       console.print(position, gf::ConsoleAlignment::Left, m_game->style(), "<style=weapon>Ammunitions</>:");
       ++position.y;
@@ -15,6 +15,7 @@ namespace ffw {
     Mount,
     Dismount,
     Reload,
+    WaitTrain,
   };
 
   struct IdleAction {
@@ -33,7 +34,10 @@ namespace ffw {
   struct ReloadAction {
   };
 
-  using HeroAction = gf::TaggedVariant<ActionType, IdleAction, MoveAction, MountAction, DismountAction, ReloadAction>;
+  struct WaitTrainAction {
+  };
+
+  using HeroAction = gf::TaggedVariant<ActionType, IdleAction, MoveAction, MountAction, DismountAction, ReloadAction, WaitTrainAction>;
 
 
   struct HeroRuntime {
@@ -65,6 +69,11 @@ namespace ffw {
       action = ReloadAction{};
     }
 
+    void wait_train()
+    {
+      action = WaitTrainAction{};
+    }
+
   };
 
 }
@@ -0,0 +1,23 @@
+#include "Logging.h"
+
+#include <atomic>
+
+namespace ffw {
+
+  namespace {
+
+    std::atomic<bool> g_debug_log_enabled(false); // the world is generated in another thread
+
+  }
+
+  bool is_debug_log_enabled()
+  {
+    return g_debug_log_enabled.load(std::memory_order_relaxed);
+  }
+
+  void set_debug_log_enabled(bool enabled)
+  {
+    g_debug_log_enabled.store(enabled, std::memory_order_relaxed);
+  }
+
+}
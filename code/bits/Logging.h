@@ -0,0 +1,30 @@
+#ifndef FFW_LOGGING_H
+#define FFW_LOGGING_H
+
+#include <gf2/core/Log.h>
+
+namespace ffw {
+
+  bool is_debug_log_enabled();
+  void set_debug_log_enabled(bool enabled);
+
+}
+
+/*
+ * The arguments of FFW_LOG_DEBUG are only evaluated when debug logs are
+ * enabled at runtime (off by default, see --debug-log), and debug logs are
+ * removed entirely when FFW_DEBUG_LOG is not defined (see xmake.lua).
+ */
+
+#ifdef FFW_DEBUG_LOG
+#define FFW_LOG_DEBUG(...)                  \
+  do {                                      \
+    if (::ffw::is_debug_log_enabled()) {    \
+      ::gf::Log::debug(__VA_ARGS__);        \
+    }                                       \
+  } while (false)
+#else
+#define FFW_LOG_DEBUG(...) do { } while (false)
+#endif
+
+#endif // FFW_LOGGING_H
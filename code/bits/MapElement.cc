@@ -5,6 +5,7 @@
 
 #include <gf2/core/Direction.h>
 
+#include "ActorRuntime.h"
 #include "ActorState.h"
 #include "FarFarWest.h"
 #include "MapCell.h"
@@ -158,25 +159,31 @@ namespace ffw {
 
     gf::ConsoleStyle actor_style;
 
-    for (const ActorState& actor : state->actors) {
-      if (!view.contains(actor.position)) {
+    const ActorRuntime& actors = runtime->actors;
+
+    for (uint32_t actor_index = 0; actor_index < actors.size(); ++actor_index) {
+      const gf::Vec2I actor_position = actors.positions[actor_index];
+
+      if (!view.contains(actor_position)) {
         continue;
       }
 
-      if (!map(actor.position).visible()) {
+      if (!map(actor_position).visible()) {
         continue;
       }
 
-      if (actor.floor != hero.floor) {
+      if (actors.floors[actor_index] != hero.floor) {
         continue;
       }
 
+      const ActorState& actor = state->actors[actor_index];
+
       actor_style.color.background = gf::Transparent;
       actor_style.color.foreground = actor.data->color;
       actor_style.effect = gf::ConsoleEffect::none();
       char16_t actor_picture = actor.data->picture;
 
-      if (actor.feature.type() == ActorType::Animal) {
+      if (actors.types[actor_index] == ActorType::Animal) {
         const uint32_t index = actor.feature.from<ActorType::Animal>().mounted_by;
 
         if (index != NoIndex) {
@@ -187,7 +194,7 @@ namespace ffw {
         }
       }
 
-      console.put_character(actor.position - view.position(), actor_picture, actor_style);
+      console.put_character(actor_position - view.position(), actor_picture, actor_style);
     }
 
     // display trains
@@ -202,10 +209,11 @@ namespace ffw {
     train_style.effect = gf::ConsoleEffect::none();
 
     for (const TrainState& train : state->network.trains) {
+      const uint32_t railway_index = runtime->network.compute_train_index(train, state->current_date);
       uint32_t offset = 0;
 
       for (char part_character : Train) {
-        const uint32_t index = runtime->network.next_position(train.railway_index, offset);
+        const uint32_t index = runtime->network.next_position(railway_index, offset);
         assert(index < runtime->network.railway.size());
         const gf::Vec2I position = runtime->network.railway[index];
 
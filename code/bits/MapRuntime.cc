@@ -1032,7 +1032,9 @@ namespace ffw {
   {
     for (const auto& [ index, actor ] : gf::enumerate(state.actors)) {
       FloorMap& floor = from_floor(actor.floor);
-      floor.reverse(actor.position).actor_index = uint32_t(index);
+      ReverseMapCell cell = floor.reverse(actor.position);
+      cell.actor_index = uint32_t(index);
+      floor.reverse.set(actor.position, cell);
     }
   }
 
@@ -13,6 +13,7 @@
 
 #include "Index.h"
 #include "MapFloor.h"
+#include "PositionMap.h"
 #include "Settings.h"
 #include "WorldGenerationStep.h"
 
@@ -40,11 +41,10 @@ namespace ffw {
 
   struct ReverseMapCell {
     uint32_t actor_index = NoIndex;
-    uint32_t train_index = NoIndex;
 
     bool empty() const
     {
-      return actor_index == NoIndex && train_index == NoIndex;
+      return actor_index == NoIndex;
     }
   };
 
@@ -66,7 +66,7 @@ namespace ffw {
 
     gf::Console console;
     gf::Array2D<RuntimeMapCell> background;
-    gf::Array2D<ReverseMapCell> reverse;
+    PositionMap<ReverseMapCell> reverse; // sparse, most cells are empty
 
     std::array<Minimap, MinimapCount> minimaps;
 
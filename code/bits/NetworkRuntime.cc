@@ -1,7 +1,143 @@
 #include "NetworkRuntime.h"
 
+#include <cassert>
+
+#include <algorithm>
+
+#include "NetworkState.h"
+
 namespace ffw {
 
+  uint32_t NetworkRuntime::station_at(uint32_t railway_index) const
+  {
+    assert(railway_index < stations.size());
+    return stations[railway_index];
+  }
+
+  uint32_t NetworkRuntime::compute_station_near(const std::vector<StationState>& stations, gf::Vec2I position) const
+  {
+    for (uint32_t station_index = 0; station_index < stations.size(); ++station_index) {
+      if (gf::chebyshev_distance(railway[stations[station_index].index], position) <= StationDistance) {
+        return station_index;
+      }
+    }
+
+    return NoIndex;
+  }
+
+  TrainStop NetworkRuntime::compute_next_arrival(uint32_t station_index, Date date) const
+  {
+    assert(station_index < timetables.size());
+    const StationTimetable& timetable = timetables[station_index];
+    assert(!timetable.arrivals.empty());
+
+    const uint64_t time = date.as_seconds();
+    const uint64_t phase = time % period();
+    uint64_t arrival = time - phase;
+
+    if (auto iterator = std::lower_bound(timetable.arrivals.begin(), timetable.arrivals.end(), phase); iterator != timetable.arrivals.end()) {
+      arrival += *iterator;
+    } else {
+      arrival += period() + timetable.arrivals.front();
+    }
+
+    TrainStop stop = {};
+    stop.arrival.timestamp = arrival;
+    stop.departure.timestamp = arrival + (arrivals[timetable.step + 1] - arrivals[timetable.step]);
+    stop.next_station = timetable.next_station;
+
+    // there is only one line, so the train goes to the next station
+    assert(timetable.next_station < timetables.size());
+    const uint64_t travel_time = (arrivals[timetables[timetable.next_station].step] + period() - arrivals[timetable.step]) % period();
+    stop.next_arrival.timestamp = arrival + travel_time;
+    return stop;
+  }
+
+  TrainStop NetworkRuntime::compute_next_departure(uint32_t station_index, Date date) const
+  {
+    assert(station_index < timetables.size());
+    const StationTimetable& timetable = timetables[station_index];
+    const uint64_t stop_time = arrivals[timetable.step + 1] - arrivals[timetable.step];
+    assert(stop_time <= date.as_seconds());
+
+    // a train that arrived less than stop_time ago is still in the station
+    Date earliest_arrival = {};
+    earliest_arrival.timestamp = date.as_seconds() - stop_time;
+    return compute_next_arrival(station_index, earliest_arrival);
+  }
+
+  uint64_t NetworkRuntime::period() const
+  {
+    assert(!arrivals.empty());
+    return arrivals.back();
+  }
+
+  TrainPosition NetworkRuntime::compute_train_position(const TrainState& train, Date date) const
+  {
+    assert(arrivals.size() == railway.size() + 1);
+    assert(!(date < train.reference));
+
+    const uint32_t reference_step = compute_step(train.railway_index);
+    const uint64_t elapsed = date.as_seconds() - train.reference.as_seconds();
+    const uint64_t phase = (arrivals[reference_step] + elapsed) % period();
+
+    // the last arrival is the period so it is always greater than the phase
+    const auto iterator = std::upper_bound(arrivals.begin(), arrivals.end(), phase);
+    assert(iterator != arrivals.begin() && iterator != arrivals.end());
+    const uint32_t step = static_cast<uint32_t>(std::distance(arrivals.begin(), iterator) - 1);
+
+    TrainPosition position = {};
+    position.railway_index = compute_step(step); // the relation is symmetric
+    position.arrival.timestamp = date.as_seconds() - (phase - arrivals[step]);
+    position.departure.timestamp = position.arrival.timestamp + (arrivals[step + 1] - arrivals[step]);
+    return position;
+  }
+
+  uint32_t NetworkRuntime::compute_train_index(const TrainState& train, Date date) const
+  {
+    if (train.awake) {
+      return train.railway_index;
+    }
+
+    return compute_train_position(train, date).railway_index;
+  }
+
+  uint32_t NetworkRuntime::compute_step(uint32_t railway_index) const
+  {
+    return static_cast<uint32_t>((railway.size() - railway_index) % railway.size());
+  }
+
+  uint32_t NetworkRuntime::compute_train_at(const std::vector<TrainState>& trains, gf::Vec2I position, Date date) const
+  {
+    if (!corridor.valid(position)) {
+      return NoIndex;
+    }
+
+    const RailwayCell cell = corridor(position);
+
+    if (cell.empty()) {
+      // far from the railway, this is the common case
+      return NoIndex;
+    }
+
+    const uint32_t railway_size = static_cast<uint32_t>(railway.size());
+
+    for (uint32_t train_index = 0; train_index < trains.size(); ++train_index) {
+      const uint32_t first = compute_train_index(trains[train_index], date);
+
+      for (uint8_t i = 0; i < cell.count; ++i) {
+        const uint32_t offset = (cell.railway_indices[i] + railway_size - first) % railway_size;
+
+        // the parts are every TrainPartSpacing railway indices from the first one
+        if (offset < TrainSpan && offset % TrainPartSpacing == 0) {
+          return train_index;
+        }
+      }
+    }
+
+    return NoIndex;
+  }
+
   uint32_t NetworkRuntime::next_position(uint32_t current, uint32_t advance) const
   {
     return (current + advance) % railway.size();
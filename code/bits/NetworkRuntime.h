@@ -1,15 +1,99 @@
 #ifndef FFW_NETWORK_RUNTIME_H
 #define FFW_NETWORK_RUNTIME_H
 
+#include <cassert>
+#include <cstdint>
+
+#include <array>
 #include <vector>
 
 #include <gf2/core/Vec2.h>
 
+#include "Date.h"
+#include "Index.h"
+#include "NetworkState.h"
+#include "PositionMap.h"
+
 namespace ffw {
   struct WorldState;
 
+  inline constexpr uint32_t TrainPartSpacing = 3;
+  inline constexpr uint32_t TrainSpan = (TrainLength - 1) * TrainPartSpacing + 1; // railway indices covered by a train
+  inline constexpr int32_t StationDistance = 15; // distance from a station where the hero can take a train
+
+  struct TrainPosition {
+    uint32_t railway_index;
+    Date arrival;
+    Date departure;
+  };
+
+  struct TrainStop {
+    Date arrival;
+    Date departure;
+    uint32_t next_station;
+    Date next_arrival; // at the next station
+  };
+
+  inline constexpr std::size_t RailwayCellCapacity = 9; // a cell is next to 9 railway cells at most
+
+  struct RailwayCell {
+    std::array<uint32_t, RailwayCellCapacity> railway_indices = {}; // railway indices next to the cell
+    uint8_t count = 0;
+
+    bool empty() const
+    {
+      return count == 0;
+    }
+
+    void add(uint32_t railway_index)
+    {
+      assert(count < RailwayCellCapacity);
+      railway_indices[count++] = railway_index;
+    }
+  };
+
+  struct StationTimetable {
+    uint32_t step;
+    uint32_t next_station;
+    std::vector<uint64_t> arrivals; // arrivals of all the trains modulo the period, sorted
+  };
+
   struct NetworkRuntime {
     std::vector<gf::Vec2I> railway;
+    std::vector<uint32_t> stations; // station for each railway index, NoIndex if there is none
+
+    // trains go backward on the railway, the steps are counted from railway index 0
+    std::vector<uint64_t> arrivals; // arrival offset of a train at each step, the last one is the period of the loop
+
+    std::vector<StationTimetable> timetables; // for each station
+
+    PositionMap<RailwayCell> corridor; // cells where a train can be, i.e. next to the railway
+
+    uint32_t station_at(uint32_t railway_index) const;
+    // station within StationDistance of the position, NoIndex if there is none
+    uint32_t compute_station_near(const std::vector<StationState>& stations, gf::Vec2I position) const;
+
+    // next train arriving at the station at or after the date
+    TrainStop compute_next_arrival(uint32_t station_index, Date date) const;
+    // next train leaving the station at or after the date
+    TrainStop compute_next_departure(uint32_t station_index, Date date) const;
+
+    uint64_t period() const;
+    TrainPosition compute_train_position(const TrainState& train, Date date) const;
+    uint32_t compute_train_index(const TrainState& train, Date date) const;
+    uint32_t compute_step(uint32_t railway_index) const;
+
+    // train that covers the position, NoIndex if there is none
+    uint32_t compute_train_at(const std::vector<TrainState>& trains, gf::Vec2I position, Date date) const;
+
+    // calls function(part, position) for each part of a train at railway_index
+    template<typename Function>
+    void for_each_train_part(uint32_t railway_index, Function function) const
+    {
+      for (uint32_t part = 0; part < TrainLength; ++part) {
+        function(part, railway[next_position(railway_index, part * TrainPartSpacing)]);
+      }
+    }
 
     uint32_t next_position(uint32_t current, uint32_t advance = 1) const;
     uint32_t prev_position(uint32_t current, uint32_t advance = 1) const;
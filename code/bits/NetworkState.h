@@ -8,6 +8,8 @@
 #include <gf2/core/TypeTraits.h>
 #include <gf2/core/Vec2.h>
 
+#include "Date.h"
+
 namespace ffw {
 
   constexpr std::size_t TrainLength = 11;
@@ -25,12 +27,14 @@ namespace ffw {
 
   struct TrainState {
     uint32_t railway_index;
+    Date reference; // date of arrival at railway_index
+    bool awake = true; // far from the hero, the train has no task and its position is computed from the date
   };
 
   template<typename Archive>
   Archive& operator|(Archive& ar, gf::MaybeConst<TrainState, Archive>& state)
   {
-    return ar | state.railway_index;
+    return ar | state.railway_index | state.reference | state.awake;
   }
 
   struct NetworkState {
@@ -0,0 +1,118 @@
+#include "Parallel.h"
+
+#include <cassert>
+
+namespace ffw {
+
+  WorkerPool::WorkerPool()
+  {
+    const std::size_t hardware_thread_count = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    m_threads.reserve(hardware_thread_count - 1);
+
+    for (std::size_t i = 1; i < hardware_thread_count; ++i) {
+      m_threads.emplace_back(&WorkerPool::work, this);
+    }
+  }
+
+  WorkerPool::~WorkerPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stopping = true;
+    }
+
+    m_job_ready.notify_all();
+
+    for (std::thread& thread : m_threads) {
+      thread.join();
+    }
+  }
+
+  std::size_t WorkerPool::thread_count() const
+  {
+    return m_threads.size() + 1;
+  }
+
+  void WorkerPool::run(std::size_t chunk_count, Callback callback, void* data)
+  {
+    if (m_running.exchange(true)) {
+      // another job is running, maybe the one that called us
+      for (std::size_t chunk = 0; chunk < chunk_count; ++chunk) {
+        callback(data, chunk);
+      }
+
+      return;
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      // a late worker may still be looking at the previous job
+      m_job_done.wait(lock, [this]() { return m_busy_workers == 0; });
+
+      m_callback = callback;
+      m_data = data;
+      m_chunk_count = chunk_count;
+      m_next_chunk.store(0);
+      ++m_generation;
+    }
+
+    m_job_ready.notify_all();
+
+    for (std::size_t chunk = m_next_chunk++; chunk < chunk_count; chunk = m_next_chunk++) {
+      callback(data, chunk);
+    }
+
+    {
+      // every chunk is taken, the workers that took one are busy until they are done
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_job_done.wait(lock, [this]() { return m_busy_workers == 0; });
+    }
+
+    m_running.store(false);
+  }
+
+  void WorkerPool::work()
+  {
+    uint64_t generation = 0;
+
+    for (;;) {
+      Callback callback = nullptr;
+      void* data = nullptr;
+      std::size_t chunk_count = 0;
+
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_job_ready.wait(lock, [&]() { return m_stopping || m_generation != generation; });
+
+        if (m_stopping) {
+          return;
+        }
+
+        generation = m_generation;
+        callback = m_callback;
+        data = m_data;
+        chunk_count = m_chunk_count;
+        ++m_busy_workers;
+      }
+
+      for (std::size_t chunk = m_next_chunk++; chunk < chunk_count; chunk = m_next_chunk++) {
+        callback(data, chunk);
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        assert(m_busy_workers > 0);
+        --m_busy_workers;
+      }
+
+      m_job_done.notify_all();
+    }
+  }
+
+  WorkerPool& worker_pool()
+  {
+    static WorkerPool pool;
+    return pool;
+  }
+
+}
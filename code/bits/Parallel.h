@@ -0,0 +1,135 @@
+#ifndef FFW_PARALLEL_H
+#define FFW_PARALLEL_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ffw {
+
+  inline constexpr std::size_t ParallelMinCountPerThread = 512;
+
+  /*
+   * A set of threads that live as long as the program, so that the threads
+   * are not created at each parallel_for(). The caller of run() works with
+   * the threads. Only one job runs at a time, a job that is started while
+   * another is running (or from inside a job) runs on the calling thread.
+   */
+
+  class WorkerPool {
+  public:
+    using Callback = void (*)(void* data, std::size_t chunk);
+
+    WorkerPool();
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    std::size_t thread_count() const; // including the calling thread
+
+    // calls callback(data, chunk) for every chunk in [0, chunk_count)
+    void run(std::size_t chunk_count, Callback callback, void* data);
+
+  private:
+    void work();
+
+    std::vector<std::thread> m_threads;
+    std::atomic<bool> m_running = false;
+
+    std::mutex m_mutex;
+    std::condition_variable m_job_ready;
+    std::condition_variable m_job_done;
+    uint64_t m_generation = 0;
+    std::size_t m_busy_workers = 0;
+    bool m_stopping = false;
+
+    Callback m_callback = nullptr;
+    void* m_data = nullptr;
+    std::size_t m_chunk_count = 0;
+    std::atomic<std::size_t> m_next_chunk = 0;
+  };
+
+  WorkerPool& worker_pool();
+
+  /*
+   * Calls function(i) for every i in [0, count) on several threads. The
+   * function must only write data that belongs to i, so that the result
+   * does not depend on the number of threads.
+   */
+
+  template<typename Function>
+  void parallel_for(std::size_t count, Function function, std::size_t min_count_per_thread = ParallelMinCountPerThread)
+  {
+    WorkerPool& pool = worker_pool();
+    const std::size_t thread_count = std::clamp<std::size_t>(count / std::max<std::size_t>(min_count_per_thread, 1), 1, pool.thread_count());
+
+    if (thread_count == 1) {
+      for (std::size_t i = 0; i < count; ++i) {
+        function(i);
+      }
+
+      return;
+    }
+
+    const std::size_t chunk_size = (count + thread_count - 1) / thread_count;
+
+    auto process_chunk = [&function, chunk_size, count](std::size_t chunk) {
+      const std::size_t begin = chunk * chunk_size;
+      const std::size_t end = std::min(begin + chunk_size, count);
+
+      for (std::size_t i = begin; i < end; ++i) {
+        function(i);
+      }
+    };
+
+    pool.run(thread_count, [](void* data, std::size_t chunk) {
+      (*static_cast<decltype(process_chunk)*>(data))(chunk);
+    }, &process_chunk);
+  }
+
+  /*
+   * A small random generator for tasks that run in parallel: each task has
+   * its own generator, seeded from the task, so that the results are the
+   * same whatever the order of the tasks.
+   */
+
+  class SplitMix64 {
+  public:
+    explicit SplitMix64(uint64_t seed)
+    : m_state(seed)
+    {
+    }
+
+    uint64_t compute_next()
+    {
+      uint64_t z = (m_state += UINT64_C(0x9e3779b97f4a7c15));
+      z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+      z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+      return z ^ (z >> 31);
+    }
+
+    // in [0, max)
+    uint32_t compute_uniform_integer(uint32_t max)
+    {
+      return static_cast<uint32_t>((compute_next() >> 32) * max >> 32);
+    }
+
+  private:
+    uint64_t m_state;
+  };
+
+  inline uint64_t compute_task_seed(uint64_t time, uint32_t index)
+  {
+    return SplitMix64(time * UINT64_C(0x100000001b3) ^ index).compute_next();
+  }
+
+}
+
+#endif // FFW_PARALLEL_H
@@ -0,0 +1 @@
+#include "PopulationState.h"
@@ -0,0 +1,63 @@
+#ifndef FFW_POPULATION_STATE_H
+#define FFW_POPULATION_STATE_H
+
+#include <cstdint>
+
+#include <vector>
+
+#include <gf2/core/TypeTraits.h>
+#include <gf2/core/Vec2.h>
+
+#include "ActorData.h"
+#include "DataReference.h"
+#include "Date.h"
+#include "Index.h"
+
+namespace ffw {
+
+  /*
+   * Far from the hero, groups of actors (herds for now) are simulated as a
+   * whole at long intervals. When the hero comes close, the group is
+   * expanded into individual actors that are simulated normally. When all
+   * the members are parked far away again, they are removed from the actors
+   * and the group is collapsed.
+   *
+   * Towns are not populated yet, so there are no town groups.
+   */
+
+  inline constexpr uint8_t HerdMinSize = 4;
+  inline constexpr uint8_t HerdMaxSize = 12;
+
+  struct HerdState {
+    DataReference<ActorData> data;
+    gf::Vec2I home; // the herd roams around its home
+    gf::Vec2I center;
+    uint8_t count = 0;
+    Date date; // date of the last update
+    uint32_t first_actor = NoIndex; // the members are contiguous in the actors once the herd is expanded
+
+    bool expanded() const
+    {
+      return first_actor != NoIndex;
+    }
+  };
+
+  template<typename Archive>
+  Archive& operator|(Archive& ar, gf::MaybeConst<HerdState, Archive>& state)
+  {
+    return ar | state.data | state.home | state.center | state.count | state.date | state.first_actor;
+  }
+
+  struct PopulationState {
+    std::vector<HerdState> herds;
+  };
+
+  template<typename Archive>
+  Archive& operator|(Archive& ar, gf::MaybeConst<PopulationState, Archive>& state)
+  {
+    return ar | state.herds;
+  }
+
+}
+
+#endif // FFW_POPULATION_STATE_H
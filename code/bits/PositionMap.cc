@@ -0,0 +1 @@
+#include "PositionMap.h"
@@ -0,0 +1,177 @@
+#ifndef FFW_POSITION_MAP_H
+#define FFW_POSITION_MAP_H
+
+#include <cassert>
+#include <cstdint>
+
+#include <vector>
+
+#include <gf2/core/Vec2.h>
+
+namespace ffw {
+
+  /*
+   * A sparse map from positions to values, for values that are empty on
+   * most of the cells. It is an open-addressing hash table with linear
+   * probing, and empty values (T::empty()) are not stored.
+   */
+
+  template<typename T>
+  class PositionMap {
+  public:
+    PositionMap() = default;
+
+    explicit PositionMap(gf::Vec2I size)
+    : m_size(size)
+    , m_entries(InitialCapacity)
+    {
+    }
+
+    gf::Vec2I size() const
+    {
+      return m_size;
+    }
+
+    bool valid(gf::Vec2I position) const
+    {
+      return 0 <= position.x && position.x < m_size.x && 0 <= position.y && position.y < m_size.y;
+    }
+
+    std::size_t count() const
+    {
+      return m_count;
+    }
+
+    T operator()(gf::Vec2I position) const
+    {
+      assert(valid(position));
+
+      if (const Entry* entry = find(compute_key(position)); entry != nullptr) {
+        return entry->value;
+      }
+
+      return T{};
+    }
+
+    void set(gf::Vec2I position, const T& value)
+    {
+      assert(valid(position));
+      const uint64_t key = compute_key(position);
+
+      if (value.empty()) {
+        erase(key);
+        return;
+      }
+
+      if (Entry* entry = find(key); entry != nullptr) {
+        entry->value = value;
+        return;
+      }
+
+      if (2 * (m_count + 1) > m_entries.size()) {
+        grow();
+      }
+
+      insert(key, value);
+    }
+
+  private:
+    static constexpr std::size_t InitialCapacity = 1024;
+    static constexpr uint64_t EmptyKey = ~UINT64_C(0);
+
+    struct Entry {
+      uint64_t key = EmptyKey;
+      T value;
+    };
+
+    static uint64_t compute_key(gf::Vec2I position)
+    {
+      return uint64_t(uint32_t(position.x)) << 32 | uint32_t(position.y);
+    }
+
+    std::size_t compute_home(uint64_t key) const
+    {
+      // Fibonacci hashing, the capacity is a power of two
+      return static_cast<std::size_t>((key * UINT64_C(0x9e3779b97f4a7c15)) >> 32) & (m_entries.size() - 1);
+    }
+
+    const Entry* find(uint64_t key) const
+    {
+      const std::size_t mask = m_entries.size() - 1;
+
+      for (std::size_t i = compute_home(key); m_entries[i].key != EmptyKey; i = (i + 1) & mask) {
+        if (m_entries[i].key == key) {
+          return &m_entries[i];
+        }
+      }
+
+      return nullptr;
+    }
+
+    Entry* find(uint64_t key)
+    {
+      return const_cast<Entry*>(static_cast<const PositionMap*>(this)->find(key));
+    }
+
+    void insert(uint64_t key, const T& value)
+    {
+      const std::size_t mask = m_entries.size() - 1;
+      std::size_t i = compute_home(key);
+
+      while (m_entries[i].key != EmptyKey) {
+        assert(m_entries[i].key != key);
+        i = (i + 1) & mask;
+      }
+
+      m_entries[i] = { key, value };
+      ++m_count;
+    }
+
+    void erase(uint64_t key)
+    {
+      Entry* entry = find(key);
+
+      if (entry == nullptr) {
+        return;
+      }
+
+      // backward shift deletion, so that there is no tombstone
+
+      const std::size_t mask = m_entries.size() - 1;
+      std::size_t hole = static_cast<std::size_t>(entry - m_entries.data());
+
+      for (std::size_t i = (hole + 1) & mask; m_entries[i].key != EmptyKey; i = (i + 1) & mask) {
+        const std::size_t home = compute_home(m_entries[i].key);
+
+        // the entry can move to the hole if its home is not in (hole, i]
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+          m_entries[hole] = m_entries[i];
+          hole = i;
+        }
+      }
+
+      m_entries[hole] = Entry{};
+      --m_count;
+    }
+
+    void grow()
+    {
+      std::vector<Entry> entries(2 * m_entries.size());
+      std::swap(entries, m_entries);
+      m_count = 0;
+
+      for (const Entry& entry : entries) {
+        if (entry.key != EmptyKey) {
+          insert(entry.key, entry.value);
+        }
+      }
+    }
+
+    gf::Vec2I m_size = { 0, 0 };
+    std::size_t m_count = 0;
+    std::vector<Entry> m_entries;
+  };
+
+}
+
+#endif // FFW_POSITION_MAP_H
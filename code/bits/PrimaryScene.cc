@@ -10,6 +10,7 @@ namespace ffw {
   , m_map_element(game)
   , m_hero_element(game)
   , m_contextual_element(game)
+  , m_scheduler_stats_element(game)
   {
     add_model(game->model());
 
@@ -17,6 +18,12 @@ namespace ffw {
     add_element(&m_map_element);
     add_element(&m_hero_element);
     add_element(&m_contextual_element);
+    add_element(&m_scheduler_stats_element);
+  }
+
+  void PrimaryScene::toggle_scheduler_stats()
+  {
+    m_scheduler_stats_element.toggle();
   }
 
 }
@@ -7,6 +7,7 @@
 #include "HeroElement.h"
 #include "MapElement.h"
 #include "MessageLogElement.h"
+#include "SchedulerStatsElement.h"
 
 namespace ffw {
   class FarFarWest;
@@ -15,6 +16,8 @@ namespace ffw {
   public:
     PrimaryScene(FarFarWest* game);
 
+    void toggle_scheduler_stats();
+
   private:
     FarFarWest* m_game = nullptr;
 
@@ -22,6 +25,7 @@ namespace ffw {
     MapElement m_map_element;
     HeroElement m_hero_element;
     ContextualElement m_contextual_element;
+    SchedulerStatsElement m_scheduler_stats_element;
   };
 
 
@@ -1,10 +1,273 @@
 #include "SchedulerState.h"
 
+#include <cassert>
+
+#include <algorithm>
+
 namespace ffw {
 
-  bool operator<(const Task& lhs, const Task& rhs)
+  namespace {
+
+    constexpr uint64_t SlotMask = SchedulerWheelSize - 1;
+    static_assert((SchedulerWheelSize & SlotMask) == 0, "The wheel size must be a power of two");
+
+    uint32_t compute_slot(uint64_t time)
+    {
+      return static_cast<uint32_t>(time & SlotMask);
+    }
+
+    int count_trailing_zeros(uint64_t word)
+    {
+      // de Bruijn sequence, see https://www.chessprogramming.org/BitScan
+      constexpr uint64_t DeBruijn = UINT64_C(0x03f79d71b4cb0a89);
+      constexpr int Table[64] = {
+         0,  1, 48,  2, 57, 49, 28,  3, 61, 58, 50, 42, 38, 29, 17,  4,
+        62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12,  5,
+        63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+        46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,  9, 13,  8,  7,  6,
+      };
+
+      assert(word != 0);
+      return Table[((word & (~word + 1)) * DeBruijn) >> 58];
+    }
+
+    bool overflow_comparator(const Task& lhs, const Task& rhs)
+    {
+      return rhs.date < lhs.date; // lhs and rhs are reversed so that smaller dates appears first in the heap
+    }
+
+  }
+
+  const Task& SchedulerState::top() const
   {
-    return rhs.date < lhs.date; // lhs and rhs are reversed so that smaller dates appears first in the queue
+    // the wheel is never empty when there are tasks in the overflow
+    assert(wheel_count > 0);
+    const std::vector<Task>& slot = wheel[compute_slot(now)];
+    assert(cursor < slot.size());
+    return slot[cursor];
+  }
+
+  void SchedulerState::push(const Task& task)
+  {
+    const uint64_t time = task.date.as_seconds();
+
+    if (empty()) {
+      now = time;
+      cursor = 0;
+    } else if (time < now) {
+      rewind(time);
+    }
+
+    insert(task, time);
+  }
+
+  void SchedulerState::pop()
+  {
+    assert(wheel_count > 0);
+
+    std::vector<Task>& slot = current_slot();
+    assert(cursor < slot.size());
+    ++cursor;
+    --wheel_count;
+
+    if (cursor == slot.size()) {
+      release_current_slot();
+    }
+  }
+
+  bool SchedulerState::remove(TaskType type, uint32_t index)
+  {
+    // this only happens when a herd is expanded, so it does not need to be efficient
+
+    auto is_task = [type, index](const Task& task) {
+      return task.type == type && task.index == index;
+    };
+
+    for (uint32_t i = 0; i < SchedulerWheelSize && wheel_count > 0; ++i) {
+      const uint32_t slot_index = compute_slot(now + i);
+      std::vector<Task>& slot = wheel[slot_index];
+      const auto begin = slot.begin() + (i == 0 ? cursor : 0);
+      const auto iterator = std::find_if(begin, slot.end(), is_task);
+
+      if (iterator == slot.end()) {
+        continue;
+      }
+
+      slot.erase(iterator);
+      --wheel_count;
+
+      if (i == 0) {
+        if (cursor == slot.size()) {
+          release_current_slot();
+        }
+      } else if (slot.empty()) {
+        occupancy[slot_index / SchedulerWordSize] &= ~(UINT64_C(1) << (slot_index % SchedulerWordSize));
+      }
+
+      return true;
+    }
+
+    if (auto iterator = std::find_if(overflow.begin(), overflow.end(), is_task); iterator != overflow.end()) {
+      overflow.erase(iterator);
+      std::make_heap(overflow.begin(), overflow.end(), overflow_comparator);
+      return true;
+    }
+
+    return false;
+  }
+
+  void SchedulerState::reschedule_top(uint16_t delay)
+  {
+    Task task = top();
+    task.date.add_seconds(delay);
+
+    // the task is inserted before the pop so that the wheel does not advance past its date
+    insert(task, task.date.as_seconds());
+    pop();
+  }
+
+  void SchedulerState::schedule_many(const std::vector<Task>& tasks)
+  {
+    if (tasks.empty()) {
+      return;
+    }
+
+    const auto earliest = std::min_element(tasks.begin(), tasks.end(), [](const Task& lhs, const Task& rhs) {
+      return lhs.date < rhs.date;
+    });
+
+    const uint64_t earliest_time = earliest->date.as_seconds();
+
+    if (empty()) {
+      now = earliest_time;
+      cursor = 0;
+    } else if (earliest_time < now) {
+      rewind(earliest_time);
+    }
+
+    const std::size_t overflow_size = overflow.size();
+
+    for (const Task& task : tasks) {
+      const uint64_t time = task.date.as_seconds();
+
+      if (time - now >= SchedulerWheelSize) {
+        overflow.push_back(task);
+      } else {
+        insert_in_wheel(task, time);
+      }
+    }
+
+    if (overflow.size() != overflow_size) {
+      std::make_heap(overflow.begin(), overflow.end(), overflow_comparator);
+    }
+  }
+
+  std::vector<Task>& SchedulerState::current_slot()
+  {
+    return wheel[compute_slot(now)];
+  }
+
+  void SchedulerState::release_current_slot()
+  {
+    const uint32_t index = compute_slot(now);
+    occupancy[index / SchedulerWordSize] &= ~(UINT64_C(1) << (index % SchedulerWordSize));
+    wheel[index].clear();
+    cursor = 0;
+    advance();
+  }
+
+  void SchedulerState::rewind(uint64_t time)
+  {
+    // this only happens when tasks are not pushed in chronological order
+    // during initialization, so it does not need to be efficient
+
+    std::vector<Task> tasks;
+    tasks.reserve(size());
+
+    for (uint32_t i = 0; i < SchedulerWheelSize; ++i) {
+      std::vector<Task>& slot = wheel[compute_slot(now + i)];
+      tasks.insert(tasks.end(), slot.begin() + (i == 0 ? cursor : 0), slot.end());
+      slot.clear();
+    }
+
+    tasks.insert(tasks.end(), overflow.begin(), overflow.end());
+    overflow.clear();
+
+    now = time;
+    cursor = 0;
+    wheel_count = 0;
+    occupancy = {};
+
+    for (const Task& task : tasks) {
+      insert(task, task.date.as_seconds());
+    }
+  }
+
+  void SchedulerState::insert(const Task& task, uint64_t time)
+  {
+    assert(time >= now);
+
+    if (time - now >= SchedulerWheelSize) {
+      overflow.push_back(task);
+      std::push_heap(overflow.begin(), overflow.end(), overflow_comparator);
+      return;
+    }
+
+    insert_in_wheel(task, time);
+  }
+
+  void SchedulerState::insert_in_wheel(const Task& task, uint64_t time)
+  {
+    const uint32_t index = compute_slot(time);
+    wheel[index].push_back(task);
+    occupancy[index / SchedulerWordSize] |= UINT64_C(1) << (index % SchedulerWordSize);
+    ++wheel_count;
+  }
+
+  void SchedulerState::advance()
+  {
+    if (wheel_count == 0) {
+      if (overflow.empty()) {
+        return;
+      }
+
+      // the wheel is empty, jump directly to the first task of the overflow
+      now = overflow.front().date.as_seconds();
+      migrate_overflow();
+      return;
+    }
+
+    // find the next occupied slot, all the tasks of the wheel are in [now, now + SchedulerWheelSize)
+
+    const uint32_t start = compute_slot(now);
+    uint32_t word_index = start / SchedulerWordSize;
+    uint64_t word = occupancy[word_index] & (~UINT64_C(0) << (start % SchedulerWordSize));
+
+    for (uint32_t i = 0; word == 0; ++i) {
+      assert(i < occupancy.size());
+      word_index = (word_index + 1) % occupancy.size();
+      word = occupancy[word_index];
+    }
+
+    const uint32_t index = word_index * SchedulerWordSize + static_cast<uint32_t>(count_trailing_zeros(word));
+    now += (index - start) & SlotMask;
+
+    migrate_overflow();
+  }
+
+  void SchedulerState::migrate_overflow()
+  {
+    while (!overflow.empty()) {
+      const uint64_t time = overflow.front().date.as_seconds();
+
+      if (time - now >= SchedulerWheelSize) {
+        break;
+      }
+
+      std::pop_heap(overflow.begin(), overflow.end(), overflow_comparator);
+      insert_in_wheel(overflow.back(), time);
+      overflow.pop_back();
+    }
   }
 
 }
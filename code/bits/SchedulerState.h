@@ -1,7 +1,10 @@
 #ifndef FFW_SCHEDULER_STATE_H
 #define FFW_SCHEDULER_STATE_H
 
-#include <queue>
+#include <cstdint>
+
+#include <array>
+#include <vector>
 
 #include <gf2/core/TaggedVariant.h>
 #include <gf2/core/TypeTraits.h>
@@ -14,6 +17,7 @@ namespace ffw {
   enum class TaskType : uint8_t {
     Actor,
     Train,
+    Herd,
   };
 
   struct Task {
@@ -28,23 +32,110 @@ namespace ffw {
     return ar | task.date | task.type | task.index;
   }
 
-  bool operator<(const Task& lhs, const Task& rhs);
+  /*
+   * The scheduler is a timing wheel: one slot per second for the next
+   * SchedulerWheelSize seconds. Almost all the delays are small (see
+   * Times.h) so tasks are inserted in constant time in their slot. The few
+   * tasks that are further in the future wait in an overflow heap and are
+   * moved to the wheel when they come within its horizon.
+   *
+   * Tasks that share the same date are processed in insertion order.
+   */
+
+  inline constexpr uint32_t SchedulerWheelSize = 4096;
+  inline constexpr uint32_t SchedulerWordSize = 64;
 
   struct SchedulerState {
-    std::priority_queue<Task> queue;
+    uint64_t now = 0; // date of the current slot, in seconds
+    uint32_t cursor = 0; // first pending task in the current slot
+    uint32_t wheel_count = 0;
+    std::vector<std::vector<Task>> wheel = std::vector<std::vector<Task>>(SchedulerWheelSize);
+    std::array<uint64_t, SchedulerWheelSize / SchedulerWordSize> occupancy = {};
+    std::vector<Task> overflow; // min-heap on dates
+
+    bool empty() const
+    {
+      return wheel_count == 0 && overflow.empty();
+    }
+
+    std::size_t size() const
+    {
+      return wheel_count + overflow.size();
+    }
+
+    const Task& top() const;
+    void push(const Task& task);
+    void pop();
+
+    // removes the pending task of this type and index, if any
+    bool remove(TaskType type, uint32_t index);
+
+    // equivalent to pop() then push() of the top task delayed
+    void reschedule_top(uint16_t delay);
+    void schedule_many(const std::vector<Task>& tasks);
 
     bool is_hero_turn() const
     {
-      const Task& top = queue.top();
-      return top.type == TaskType::Actor && top.index == 0;
+      const Task& task = top();
+      return task.type == TaskType::Actor && task.index == 0;
+    }
+
+    // removes the tasks of the current date that verify the predicate, the other tasks keep their order
+    template<typename Predicate>
+    void pop_current_if(Predicate predicate, std::vector<Task>& popped)
+    {
+      if (wheel_count == 0) {
+        return;
+      }
+
+      std::vector<Task>& slot = current_slot();
+      std::size_t kept = cursor;
+
+      for (std::size_t i = cursor; i < slot.size(); ++i) {
+        if (predicate(slot[i])) {
+          popped.push_back(slot[i]);
+        } else {
+          slot[kept++] = slot[i];
+        }
+      }
+
+      wheel_count -= static_cast<uint32_t>(slot.size() - kept);
+      slot.resize(kept);
+
+      if (cursor == slot.size()) {
+        release_current_slot();
+      }
+    }
+
+    // the function can change the index of the tasks, not their date
+    template<typename Function>
+    void update_indices(Function function)
+    {
+      for (std::vector<Task>& slot : wheel) {
+        for (Task& task : slot) {
+          function(task);
+        }
+      }
+
+      for (Task& task : overflow) {
+        function(task);
+      }
     }
 
+  private:
+    std::vector<Task>& current_slot();
+    void release_current_slot();
+    void rewind(uint64_t time);
+    void insert(const Task& task, uint64_t time);
+    void insert_in_wheel(const Task& task, uint64_t time);
+    void advance();
+    void migrate_overflow();
   };
 
   template<typename Archive>
   Archive& operator|(Archive& ar, gf::MaybeConst<SchedulerState, Archive>& state)
   {
-    return ar | state.queue;
+    return ar | state.now | state.cursor | state.wheel_count | state.wheel | state.occupancy | state.overflow;
   }
 
 }
@@ -0,0 +1,103 @@
+#include "SchedulerStats.h"
+
+#include <cassert>
+
+#include <algorithm>
+#include <fstream>
+
+#include <nlohmann/json.hpp>
+
+#include <gf2/core/Log.h>
+
+namespace ffw {
+
+  namespace {
+
+    constexpr std::string_view TaskTypeNames[TaskTypeCount] = { "actor", "train", "herd" };
+
+    std::size_t compute_delay_bucket(uint64_t delay)
+    {
+      std::size_t bucket = 0;
+
+      while (delay > 1 && bucket + 1 < DelayHistogramSize) {
+        delay >>= 1;
+        ++bucket;
+      }
+
+      return bucket;
+    }
+
+  }
+
+  std::string_view to_string(TaskType type)
+  {
+    assert(std::size_t(type) < TaskTypeCount);
+    return TaskTypeNames[std::size_t(type)];
+  }
+
+  void SchedulerStats::start_frame()
+  {
+    for (TaskTypeStats& stats : types) {
+      stats.frame_count = 0;
+      stats.frame_time = {};
+    }
+  }
+
+  void SchedulerStats::end_frame(std::size_t depth)
+  {
+    ++frames;
+    queue_depth = depth;
+    max_queue_depth = std::max(max_queue_depth, depth);
+  }
+
+  void SchedulerStats::add_tasks(TaskType type, uint64_t count, gf::Time time)
+  {
+    assert(std::size_t(type) < TaskTypeCount);
+    TaskTypeStats& stats = types[std::size_t(type)];
+    stats.frame_count += count;
+    stats.total_count += count;
+    stats.frame_time += time;
+    stats.total_time += time;
+  }
+
+  void SchedulerStats::add_delay(uint64_t delay)
+  {
+    ++delays[compute_delay_bucket(delay)];
+  }
+
+  uint64_t SchedulerStats::frame_count() const
+  {
+    uint64_t count = 0;
+
+    for (const TaskTypeStats& stats : types) {
+      count += stats.frame_count;
+    }
+
+    return count;
+  }
+
+  void SchedulerStats::save_to_file(const std::filesystem::path& filename) const
+  {
+    nlohmann::json json;
+    json["frames"] = frames;
+    json["queue_depth"] = queue_depth;
+    json["max_queue_depth"] = max_queue_depth;
+
+    for (std::size_t i = 0; i < TaskTypeCount; ++i) {
+      const TaskTypeStats& stats = types[i];
+      nlohmann::json& type = json["types"][std::string(TaskTypeNames[i])];
+      type["frame_count"] = stats.frame_count;
+      type["total_count"] = stats.total_count;
+      type["frame_seconds"] = stats.frame_time.as_seconds();
+      type["total_seconds"] = stats.total_time.as_seconds();
+    }
+
+    json["delays"] = delays;
+
+    std::ofstream ofs(filename);
+    ofs << json.dump(2) << '\n';
+
+    gf::Log::info("Scheduler stats saved to {}", filename.string());
+  }
+
+}
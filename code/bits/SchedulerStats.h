@@ -0,0 +1,48 @@
+#ifndef FFW_SCHEDULER_STATS_H
+#define FFW_SCHEDULER_STATS_H
+
+#include <cstdint>
+
+#include <array>
+#include <filesystem>
+#include <string_view>
+
+#include <gf2/core/Time.h>
+
+#include "SchedulerState.h"
+
+namespace ffw {
+
+  inline constexpr std::size_t TaskTypeCount = 3;
+  inline constexpr std::size_t DelayHistogramSize = 16;
+
+  std::string_view to_string(TaskType type);
+
+  struct TaskTypeStats {
+    uint64_t frame_count = 0;
+    uint64_t total_count = 0;
+    gf::Time frame_time;
+    gf::Time total_time;
+  };
+
+  struct SchedulerStats {
+    uint64_t frames = 0;
+    std::array<TaskTypeStats, TaskTypeCount> types = {};
+    std::size_t queue_depth = 0;
+    std::size_t max_queue_depth = 0;
+    std::array<uint64_t, DelayHistogramSize> delays = {}; // bucket i counts the delays in [2^i, 2^(i+1)), bucket 0 also counts 0
+
+    void start_frame();
+    void end_frame(std::size_t depth);
+
+    void add_tasks(TaskType type, uint64_t count, gf::Time time);
+    void add_delay(uint64_t delay);
+
+    uint64_t frame_count() const;
+
+    void save_to_file(const std::filesystem::path& filename) const;
+  };
+
+}
+
+#endif // FFW_SCHEDULER_STATS_H
@@ -0,0 +1,80 @@
+#include "SchedulerStatsElement.h"
+
+#include <algorithm>
+#include <string>
+
+#include "FarFarWest.h"
+#include "SchedulerStats.h"
+#include "Settings.h"
+
+namespace ffw {
+
+  namespace {
+
+    constexpr gf::Vec2I SchedulerStatsConsolePosition = GameBoxPosition + 1;
+    constexpr gf::Vec2I SchedulerStatsConsoleSize = { 34, 28 };
+    constexpr float SchedulerStatsBackgroundAlpha = 0.8f;
+
+    constexpr int32_t HistogramBarMaxLength = 20;
+
+  }
+
+  SchedulerStatsElement::SchedulerStatsElement(FarFarWest* game)
+  : m_game(game)
+  , m_console(SchedulerStatsConsoleSize)
+  {
+  }
+
+  void SchedulerStatsElement::toggle()
+  {
+    m_visible = !m_visible;
+  }
+
+  void SchedulerStatsElement::update([[maybe_unused]] gf::Time time)
+  {
+  }
+
+  void SchedulerStatsElement::render(gf::Console& console)
+  {
+    if (!m_visible) {
+      return;
+    }
+
+    const SchedulerStats& stats = m_game->runtime()->scheduler_stats;
+
+    gf::ConsoleStyle box_style;
+    box_style.color.foreground = gf::Gray;
+    box_style.color.background = gf::Black;
+    m_console.clear(box_style);
+    m_console.draw_frame(gf::RectI::from_size(SchedulerStatsConsoleSize), box_style);
+
+    gf::Vec2I position = { 1, 1 };
+    m_console.print(position, gf::ConsoleAlignment::Left, m_game->style(), "<style=character>Scheduler</> (frame {})", stats.frames);
+    position.y += 2;
+    m_console.print(position, gf::ConsoleAlignment::Left, m_game->style(), "Tasks: {}", stats.frame_count());
+    ++position.y;
+    m_console.print(position, gf::ConsoleAlignment::Left, m_game->style(), "Queue: {} (max {})", stats.queue_depth, stats.max_queue_depth);
+    position.y += 2;
+
+    for (std::size_t i = 0; i < TaskTypeCount; ++i) {
+      const TaskTypeStats& type_stats = stats.types[i];
+      m_console.print(position, gf::ConsoleAlignment::Left, m_game->style(), "{}: {} ({:.2f} ms)", to_string(TaskType(i)), type_stats.frame_count, type_stats.frame_time.as_seconds() * 1000.0f);
+      ++position.y;
+    }
+
+    ++position.y;
+    m_console.print(position, gf::ConsoleAlignment::Left, m_game->style(), "Reschedule delays:");
+    ++position.y;
+
+    const uint64_t max_delays = std::max<uint64_t>(*std::max_element(stats.delays.begin(), stats.delays.end()), 1);
+
+    for (std::size_t i = 0; i < DelayHistogramSize; ++i) {
+      const int32_t length = static_cast<int32_t>(stats.delays[i] * HistogramBarMaxLength / max_delays);
+      m_console.print(position, gf::ConsoleAlignment::Left, m_game->style(), "{:>5} {}", uint64_t(1) << i, std::string(std::size_t(length), '#'));
+      ++position.y;
+    }
+
+    m_console.blit_to(console, gf::RectI::from_size(SchedulerStatsConsoleSize), SchedulerStatsConsolePosition, 1.0f, SchedulerStatsBackgroundAlpha);
+  }
+
+}
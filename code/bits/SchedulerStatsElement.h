@@ -0,0 +1,27 @@
+#ifndef FFW_SCHEDULER_STATS_ELEMENT_H
+#define FFW_SCHEDULER_STATS_ELEMENT_H
+
+#include <gf2/core/Console.h>
+#include <gf2/core/ConsoleElement.h>
+
+namespace ffw {
+  class FarFarWest;
+
+  class SchedulerStatsElement : public gf::ConsoleElement {
+  public:
+    SchedulerStatsElement(FarFarWest* game);
+
+    void toggle();
+
+    void update(gf::Time time) override;
+    void render(gf::Console& console) override;
+
+  private:
+    FarFarWest* m_game = nullptr;
+    bool m_visible = false;
+    gf::Console m_console;
+  };
+
+}
+
+#endif // FFW_SCHEDULER_STATS_ELEMENT_H
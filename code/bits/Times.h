@@ -17,6 +17,8 @@ namespace ffw {
   constexpr uint16_t GrazeTime = 100;
   constexpr uint16_t IdleTime = 100;
 
+  constexpr uint16_t HerdTime = 3600;
+
 }
 
 #endif // FFW_TIMES_H
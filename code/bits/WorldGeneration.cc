@@ -1,10 +1,23 @@
 #include "WorldGeneration.h"
 
+#include <cassert>
 #include <cstdint>
 
 #include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <optional>
 #include <queue>
+#include <random>
+#include <string>
 #include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include <gf2/core/Array2D.h>
 #include <gf2/core/Clock.h>
@@ -13,7 +26,6 @@
 #include <gf2/core/FieldOfVision.h>
 #include <gf2/core/Geometry.h>
 #include <gf2/core/GridMap.h>
-#include <gf2/core/Heightmap.h>
 #include <gf2/core/Log.h>
 #include <gf2/core/Noises.h>
 #include <gf2/core/ProcGen.h>
@@ -22,21 +34,25 @@
 #include "ActorState.h"
 #include "Colors.h"
 #include "Date.h"
+#include "Logging.h"
 #include "MapCell.h"
 #include "MapState.h"
 #include "Names.h"
+#include "Parallel.h"
 #include "Settings.h"
 
 namespace ffw {
 
   namespace {
 
-    constexpr bool Debug = true;
-
     constexpr double WorldNoiseScale = WorldBasicSize / 256.0;
 
     constexpr int32_t WorldPaddingSize = 150;
 
+    constexpr int32_t RawTileSize = 128;
+    constexpr int32_t RawTileCount = WorldBasicSize / RawTileSize;
+    static_assert(WorldBasicSize % RawTileSize == 0);
+
     constexpr double AltitudeThreshold = 0.55;
     constexpr double MoistureLoThreshold = 0.45;
     constexpr double MoistureHiThreshold = 0.55;
@@ -86,6 +102,13 @@ namespace ffw {
     constexpr int32_t CaveMinDistance = 10;
     constexpr int32_t CaveLinkDistance = 70;
 
+    constexpr std::size_t HerdsPerFarm = 2;
+    constexpr int32_t HerdMinDistanceFromFarm = LocalityRadius + 5;
+    constexpr int32_t HerdMaxDistanceFromFarm = LocalityRadius + 40;
+    constexpr int MaxHerdHomeTries = 50;
+
+    constexpr uint32_t MaxTerrainAttempts = 10; // terrains generated until the places fit
+
     bool is_on_side(gf::Vec2I position)
     {
       return position.x == 0 || position.x == WorldBasicSize - 1 || position.y == 0 || position.y == WorldBasicSize - 1;
@@ -147,66 +170,217 @@ namespace ffw {
       return image;
     }
 
+    /*
+     * The debug images are encoded and saved on a background thread, so that
+     * the generation does not wait for the PNG compression.
+     */
+
+    class DebugImages {
+    public:
+      explicit DebugImages(bool enabled)
+      : m_enabled(enabled)
+      {
+        if (m_enabled) {
+          m_thread = std::thread(&DebugImages::run, this);
+        }
+      }
+
+      DebugImages(const DebugImages&) = delete;
+      DebugImages& operator=(const DebugImages&) = delete;
+
+      ~DebugImages()
+      {
+        if (!m_enabled) {
+          return;
+        }
+
+        {
+          const std::lock_guard lock(m_mutex);
+          m_done = true;
+        }
+
+        m_condition.notify_one();
+        m_thread.join();
+      }
+
+      bool enabled() const
+      {
+        return m_enabled;
+      }
+
+      void save(gf::Image image, std::string filename)
+      {
+        assert(m_enabled);
+
+        {
+          const std::lock_guard lock(m_mutex);
+          m_pending.push_back({ std::move(image), std::move(filename) });
+        }
+
+        m_condition.notify_one();
+      }
+
+    private:
+      struct PendingImage {
+        gf::Image image;
+        std::string filename;
+      };
+
+      void run()
+      {
+        for (;;) {
+          std::unique_lock lock(m_mutex);
+          m_condition.wait(lock, [this]() { return m_done || !m_pending.empty(); });
+
+          if (m_pending.empty()) {
+            return; // done and nothing left
+          }
+
+          PendingImage pending = std::move(m_pending.front());
+          m_pending.pop_front();
+          lock.unlock();
+
+          pending.image.save_to_file(pending.filename);
+        }
+      }
+
+      bool m_enabled = false;
+      bool m_done = false;
+      std::mutex m_mutex;
+      std::condition_variable m_condition;
+      std::deque<PendingImage> m_pending;
+      std::thread m_thread;
+    };
+
     /*
      * Step 1. Generate a raw map.
      *
      * The raw map is just the combination of two Perlin noises. One for
      * altitude and one for moisture.
      *
-     * The values are used many times in the process but are not kept in the
-     * final state of the game.
+     * The values are used for the outline and then released. The routing
+     * steps only need the altitude at the reduced resolution.
      */
 
     struct RawCell {
-      double altitude;
-      double moisture;
+      float altitude;
+      float moisture;
     };
 
     using RawWorld = gf::Array2D<RawCell>;
+    using ReducedAltitude = gf::Array2D<float>;
+
+    struct RawRange {
+      double altitude_min = std::numeric_limits<double>::max();
+      double altitude_max = std::numeric_limits<double>::lowest();
+      double moisture_min = std::numeric_limits<double>::max();
+      double moisture_max = std::numeric_limits<double>::lowest();
+    };
+
+    gf::RectI compute_raw_tile(std::size_t tile)
+    {
+      const gf::Vec2I position = gf::Vec2I(int32_t(tile % RawTileCount), int32_t(tile / RawTileCount)) * RawTileSize;
+      return gf::RectI::from_position_size(position, { RawTileSize, RawTileSize });
+    }
 
     RawWorld generate_raw(gf::Random* random)
     {
       RawWorld raw(WorldSize);
 
       gf::PerlinNoise2D altitude_noise(random, WorldNoiseScale);
-      gf::Heightmap altitude_heightmap(WorldSize);
-      altitude_heightmap.add_noise(&altitude_noise);
-      altitude_heightmap.normalize();
-
       gf::PerlinNoise2D moisture_noise(random, WorldNoiseScale);
-      gf::Heightmap moisture_heightmap(WorldSize);
-      moisture_heightmap.add_noise(&moisture_noise);
-      moisture_heightmap.normalize();
 
-      for (const gf::Vec2I position : raw.position_range()) {
-        RawCell& cell = raw(position);
-        cell.altitude = altitude_heightmap.value(position);
-        cell.moisture = moisture_heightmap.value(position);
+      // first pass: the noises, in tiles, with the range of each tile
+      // (the noises only depend on the position so the result does not depend on the number of threads)
 
-        double factor = 1.0;
+      constexpr std::size_t TileCount = std::size_t(RawTileCount) * RawTileCount;
+      std::vector<RawRange> ranges(TileCount);
 
-        if (position.x < WorldPaddingSize) {
-          factor *= double(position.x) / double (WorldPaddingSize);
-        } else if (position.x >= WorldSize.x - WorldPaddingSize) {
-          factor *= double(WorldSize.x - position.x - 1) / double (WorldPaddingSize);
-        }
+      parallel_for(TileCount, [&](std::size_t tile) {
+        const gf::RectI rectangle = compute_raw_tile(tile);
+        RawRange& range = ranges[tile];
+
+        for (const gf::Vec2I relative_position : gf::position_range(rectangle.size())) {
+          const gf::Vec2I position = rectangle.position() + relative_position;
+          // same coordinates as gf::Heightmap::add_noise()
+          const double x = double(position.x) / double(WorldSize.x);
+          const double y = double(position.y) / double(WorldSize.y);
+
+          const double altitude = altitude_noise.value(x, y);
+          const double moisture = moisture_noise.value(x, y);
 
-        if (position.y < WorldPaddingSize) {
-          factor *= double(position.y) / double (WorldPaddingSize);
-        } else if (position.y >= WorldSize.y - WorldPaddingSize) {
-          factor *= double(WorldSize.y - 1 - position.y) / double (WorldPaddingSize);
+          RawCell& cell = raw(position);
+          cell.altitude = static_cast<float>(altitude);
+          cell.moisture = static_cast<float>(moisture);
+
+          // the range is computed on the stored values so that the normalized values are in [0, 1]
+          range.altitude_min = std::min(range.altitude_min, double(cell.altitude));
+          range.altitude_max = std::max(range.altitude_max, double(cell.altitude));
+          range.moisture_min = std::min(range.moisture_min, double(cell.moisture));
+          range.moisture_max = std::max(range.moisture_max, double(cell.moisture));
         }
+      }, 1);
+
+      RawRange range;
 
-        cell.altitude = 1.0 - (1.0 - cell.altitude) * gf::ease_out_cubic(factor);
+      for (const RawRange& tile_range : ranges) {
+        range.altitude_min = std::min(range.altitude_min, tile_range.altitude_min);
+        range.altitude_max = std::max(range.altitude_max, tile_range.altitude_max);
+        range.moisture_min = std::min(range.moisture_min, tile_range.moisture_min);
+        range.moisture_max = std::max(range.moisture_max, tile_range.moisture_max);
       }
 
+      const double altitude_range = std::max(range.altitude_max - range.altitude_min, std::numeric_limits<double>::epsilon());
+      const double moisture_range = std::max(range.moisture_max - range.moisture_min, std::numeric_limits<double>::epsilon());
+
+      // second pass: normalization and falloff on the sides
+
+      parallel_for(TileCount, [&](std::size_t tile) {
+        const gf::RectI rectangle = compute_raw_tile(tile);
+
+        for (const gf::Vec2I relative_position : gf::position_range(rectangle.size())) {
+          const gf::Vec2I position = rectangle.position() + relative_position;
+
+          RawCell& cell = raw(position);
+          const double altitude = (cell.altitude - range.altitude_min) / altitude_range;
+          cell.moisture = static_cast<float>((cell.moisture - range.moisture_min) / moisture_range);
+
+          double factor = 1.0;
+
+          if (position.x < WorldPaddingSize) {
+            factor *= double(position.x) / double (WorldPaddingSize);
+          } else if (position.x >= WorldSize.x - WorldPaddingSize) {
+            factor *= double(WorldSize.x - position.x - 1) / double (WorldPaddingSize);
+          }
+
+          if (position.y < WorldPaddingSize) {
+            factor *= double(position.y) / double (WorldPaddingSize);
+          } else if (position.y >= WorldSize.y - WorldPaddingSize) {
+            factor *= double(WorldSize.y - 1 - position.y) / double (WorldPaddingSize);
+          }
+
+          cell.altitude = static_cast<float>(1.0 - (1.0 - altitude) * gf::ease_out_cubic(factor));
+        }
+      }, 1);
+
       return raw;
     }
 
-    float distance_with_slope(const RawWorld& raw, gf::Vec2I position, gf::Vec2I neighbor)
+    ReducedAltitude compute_reduced_altitude(const RawWorld& raw)
+    {
+      ReducedAltitude altitude(WorldSize / ReducedFactor);
+
+      for (const gf::Vec2I position : altitude.position_range()) {
+        altitude(position) = raw(to_map(position)).altitude;
+      }
+
+      return altitude;
+    }
+
+    float distance_with_slope(const ReducedAltitude& altitude, gf::Vec2I position, gf::Vec2I neighbor)
     {
       const float distance = gf::euclidean_distance<float>(position, neighbor);
-      const float slope = static_cast<float>(std::abs(raw(to_map(position)).altitude - raw(to_map(neighbor)).altitude)) / distance;
+      const float slope = std::abs(altitude(position) - altitude(neighbor)) / distance;
       return distance * (1 + SlopeFactor * gf::square(slope));
     }
 
@@ -221,7 +395,7 @@ namespace ffw {
      * herbs.
      */
 
-    MapState generate_outline(const RawWorld& raw, gf::Random* random)
+    MapState generate_outline(const RawWorld& raw, gf::Random* random, DebugImages& debug)
     {
       MapState state = {};
       state.ground = { WorldSize };
@@ -269,9 +443,9 @@ namespace ffw {
         }
       }
 
-      if constexpr (Debug) {
+      if (debug.enabled()) {
         gf::Image image = compute_basic_image(state.ground);
-        image.save_to_file("00_outline.png");
+        debug.save(std::move(image), "00_outline.png");
       }
 
       return state;
@@ -284,24 +458,124 @@ namespace ffw {
      * all the blocks are in place.
      */
 
-    void generate_mountains(MapState& state, gf::Random* random)
+    /*
+     * A grid of bits packed in rows of 64-bit words. The bits outside of the
+     * grid are always 0.
+     */
+
+    struct BitGrid {
+      explicit BitGrid(gf::Vec2I grid_size)
+      : size(grid_size)
+      , words_per_row((grid_size.x + 63) / 64)
+      , words(std::size_t(words_per_row) * std::size_t(grid_size.y), 0)
+      {
+      }
+
+      gf::Vec2I size;
+      int32_t words_per_row;
+      std::vector<uint64_t> words;
+
+      bool test(gf::Vec2I position) const
+      {
+        return ((row(position.y)[position.x / 64] >> (position.x % 64)) & 1) != 0;
+      }
+
+      void set(gf::Vec2I position)
+      {
+        row(position.y)[position.x / 64] |= UINT64_C(1) << (position.x % 64);
+      }
+
+      uint64_t* row(int32_t y)
+      {
+        return words.data() + std::size_t(y) * std::size_t(words_per_row);
+      }
+
+      const uint64_t* row(int32_t y) const
+      {
+        return words.data() + std::size_t(y) * std::size_t(words_per_row);
+      }
+
+      // the row y, or a row of 0 outside of the grid
+      const uint64_t* row_or(int32_t y, const std::vector<uint64_t>& zero) const
+      {
+        return 0 <= y && y < size.y ? row(y) : zero.data();
+      }
+
+      uint64_t last_word_mask() const
+      {
+        return size.x % 64 == 0 ? ~UINT64_C(0) : (UINT64_C(1) << (size.x % 64)) - 1;
+      }
+    };
+
+    // value at x - shift for each bit x
+    uint64_t shift_from_west(const uint64_t* row, int32_t i, int shift)
     {
-      enum Type : uint8_t {
-        Ground,
-        Cliff,
-      };
+      return (row[i] << shift) | (i > 0 ? row[i - 1] >> (64 - shift) : 0);
+    }
+
+    // value at x + shift for each bit x
+    uint64_t shift_from_east(const uint64_t* row, int32_t i, int32_t words_per_row, int shift)
+    {
+      return (row[i] >> shift) | (i + 1 < words_per_row ? row[i + 1] << (64 - shift) : 0);
+    }
+
+    /*
+     * 64 counters in parallel, one per bit, with a binary number in 4 words.
+     */
 
-      gf::Array2D<Type> map(WorldSize, Ground);
+    struct BitCounter {
+      std::array<uint64_t, 4> digits = {};
+
+      void add(uint64_t bits)
+      {
+        for (uint64_t& digit : digits) {
+          const uint64_t carry = digit & bits;
+          digit ^= bits;
+          bits = carry;
+        }
+      }
+
+      // bits where the counter is at least threshold
+      uint64_t at_least(unsigned threshold) const
+      {
+        uint64_t greater = 0;
+        uint64_t equal = ~UINT64_C(0);
+
+        for (std::size_t k = digits.size(); k-- > 0; ) {
+          if (((threshold >> k) & 1) != 0) {
+            equal &= digits[k];
+          } else {
+            greater |= equal & digits[k];
+            equal &= ~digits[k];
+          }
+        }
+
+        return greater | equal;
+      }
+    };
+
+    void generate_mountains(MapState& state, gf::Random* random, DebugImages& debug)
+    {
+      // the automaton works on the ground bits, a bit is 0 for a cliff
+
+      BitGrid ground(WorldSize);
+      BitGrid mountain(WorldSize);
 
       for (const gf::Vec2I position : state.ground.position_range()) {
         if (state.ground(position).region == MapCellBiome::Moutain) {
+          mountain.set(position);
+
           if (random->compute_bernoulli(MoutainThreshold)) {
-            map(position) = Cliff;
+            continue;
           }
         }
+
+        ground.set(position);
       }
 
-      gf::Array2D<Type> next(WorldSize);
+      BitGrid next(WorldSize);
+      const std::vector<uint64_t> zero(std::size_t(ground.words_per_row), 0);
+      const int32_t words_per_row = ground.words_per_row;
 
       /*
        * +-+-+-+-+-+
@@ -315,95 +589,89 @@ namespace ffw {
        * +-+-+-+-+-+
        * | | |X| | |
        * +-+-+-+-+-+
+       *
+       * The twelve neighbors are counted for 64 cells at once. Outside of
+       * the mountains, the cells stay ground.
        */
 
-
-      static constexpr gf::Vec2I TwelveNeighbors[] = {
-        // clang-format off
-                                {  0, -2 },
-                    { -1, -1 }, {  0, -1 }, { +1, -1 },
-        { -2,  0 }, { -1,  0 },             { +1,  0 }, { +2, 0 },
-                    { -1, +1 }, {  0, +1 }, { +1, +1 },
-                                {  0, +2 },
-        // clang-format on
-      };
+      static_assert(MoutainSurvivalThreshold <= 12 && MoutainBirthThreshold <= 12);
 
       for (int i = 0; i < MoutainIterations; ++i) {
-        for (const gf::Vec2I position : map.position_range()) {
-          if (state.ground(position).region != MapCellBiome::Moutain) {
-            continue;
-          }
-
-          int count = 0;
-
-          for (const gf::Vec2I relative_neighbor : TwelveNeighbors) {
-            const gf::Vec2I neighbor = position + relative_neighbor;
-
-            if (map.valid(neighbor)) {
-              count += map(neighbor) == Ground ? 1 : 0;
-            }
+        parallel_for(std::size_t(WorldSize.y), [&](std::size_t row_index) {
+          const int32_t y = int32_t(row_index);
+
+          const uint64_t* row_n2 = ground.row_or(y - 2, zero);
+          const uint64_t* row_n1 = ground.row_or(y - 1, zero);
+          const uint64_t* row = ground.row(y);
+          const uint64_t* row_s1 = ground.row_or(y + 1, zero);
+          const uint64_t* row_s2 = ground.row_or(y + 2, zero);
+          const uint64_t* mountain_row = mountain.row(y);
+          uint64_t* next_row = next.row(y);
+
+          for (int32_t w = 0; w < words_per_row; ++w) {
+            BitCounter counter;
+            counter.add(row_n2[w]);
+            counter.add(shift_from_west(row_n1, w, 1));
+            counter.add(row_n1[w]);
+            counter.add(shift_from_east(row_n1, w, words_per_row, 1));
+            counter.add(shift_from_west(row, w, 2));
+            counter.add(shift_from_west(row, w, 1));
+            counter.add(shift_from_east(row, w, words_per_row, 1));
+            counter.add(shift_from_east(row, w, words_per_row, 2));
+            counter.add(shift_from_west(row_s1, w, 1));
+            counter.add(row_s1[w]);
+            counter.add(shift_from_east(row_s1, w, words_per_row, 1));
+            counter.add(row_s2[w]);
+
+            const uint64_t survival = row[w] & counter.at_least(MoutainSurvivalThreshold);
+            const uint64_t birth = ~row[w] & counter.at_least(MoutainBirthThreshold);
+            next_row[w] = ~mountain_row[w] | survival | birth;
           }
 
-          if (map(position) == Ground) {
-            if (count >= MoutainSurvivalThreshold) {
-              next(position) = Ground;
-            } else {
-              next(position) = Cliff;
-            }
-          } else {
-            if (count >= MoutainBirthThreshold) {
-              next(position) = Ground;
-            } else {
-              next(position) = Cliff;
-            }
-          }
-        }
+          next_row[words_per_row - 1] &= ground.last_word_mask();
+        }, 64);
 
-        std::swap(map, next);
+        std::swap(ground, next);
       }
 
       // check for isolated Ground
 
-      constexpr gf::Vec2I FourNeighbors[] = {
-        { 0, -1 }, { -1, 0 }, { +1, 0 }, { 0, +1 }
-      };
+      parallel_for(std::size_t(WorldSize.y), [&](std::size_t row_index) {
+        const int32_t y = int32_t(row_index);
 
-      for (const gf::Vec2I position : map.position_range()) {
-        if (state.ground(position).region != MapCellBiome::Moutain) {
-          continue;
-        }
+        const uint64_t* row_n1 = ground.row_or(y - 1, zero);
+        const uint64_t* row = ground.row(y);
+        const uint64_t* row_s1 = ground.row_or(y + 1, zero);
+        const uint64_t* mountain_row = mountain.row(y);
+        uint64_t* next_row = next.row(y);
 
-        if (map(position) == Ground) {
-          bool isolated = true;
+        for (int32_t w = 0; w < words_per_row; ++w) {
+          const uint64_t neighbors = row_n1[w] | shift_from_west(row, w, 1) | shift_from_east(row, w, words_per_row, 1) | row_s1[w];
+          next_row[w] = row[w] & ~(mountain_row[w] & ~neighbors);
+        }
+      }, 64);
 
-          for (const gf::Vec2I relative_neighbor : FourNeighbors) {
-            const gf::Vec2I neighbor = position + relative_neighbor;
+      std::swap(ground, next);
 
-            if (map.valid(neighbor) && map(neighbor) == Ground) {
-              isolated = false;
-              break;
-            }
-          }
+      // put in outline
 
-          if (isolated) {
-            map(position) = Cliff;
-          }
-        }
-      }
+      parallel_for(std::size_t(WorldSize.y), [&](std::size_t row_index) {
+        const int32_t y = int32_t(row_index);
 
-      // put in outline
+        for (int32_t x = 0; x < WorldSize.x; ++x) {
+          const gf::Vec2I position = { x, y };
 
-      for (const gf::Vec2I position : map.position_range()) {
-        if (map(position) == Cliff) {
-          state.ground(position).decoration = MapCellDecoration::Cliff;
-        } else if (state.ground(position).region == MapCellBiome::Moutain && is_on_side(position)) {
-          state.ground(position).decoration = MapCellDecoration::Cliff;
+          if (!ground.test(position)) {
+            state.ground(position).decoration = MapCellDecoration::Cliff;
+          } else if (mountain.test(position) && is_on_side(position)) {
+            state.ground(position).decoration = MapCellDecoration::Cliff;
+          }
         }
-      }
+      }, 64);
 
-      if constexpr (Debug) {
+      if (debug.enabled()) {
         gf::Image image = compute_basic_image(state.ground, ImageType::Blocks);
-        image.save_to_file("01_blocks.png");
+        debug.save(std::move(image), "01_blocks.png");
       }
 
     }
@@ -520,54 +788,188 @@ namespace ffw {
     }
 
 
-    bool can_have_place(const MapState& state, gf::Vec2I position, int32_t radius)
+    /*
+     * Summed-area table of the cells that verify a predicate: the value at
+     * (x, y) is the number of such cells in [0, x) x [0, y). So the number of
+     * cells in any rectangle is computed with four values.
+     */
+
+    using SummedAreaTable = gf::Array2D<uint32_t>;
+
+    template<typename Predicate>
+    SummedAreaTable compute_summed_area_table(const BackgroundMap& map, Predicate predicate)
     {
-      assert(state.ground.valid(position));
+      SummedAreaTable table(WorldSize + 1, 0);
+
+      for (int32_t y = 0; y < WorldSize.y; ++y) {
+        uint32_t row_sum = 0;
 
-      if (state.ground(position).region != MapCellBiome::Prairie) {
+        for (int32_t x = 0; x < WorldSize.x; ++x) {
+          row_sum += predicate(map({ x, y })) ? 1 : 0;
+          table({ x + 1, y + 1 }) = table({ x + 1, y }) + row_sum;
+        }
+      }
+
+      return table;
+    }
+
+    // number of cells in [min, max)
+    uint32_t compute_summed_area(const SummedAreaTable& table, gf::Vec2I min, gf::Vec2I max)
+    {
+      return table(max) + table(min) - table({ min.x, max.y }) - table({ max.x, min.y });
+    }
+
+    bool can_have_place(const SummedAreaTable& non_prairie, gf::Vec2I position, int32_t radius)
+    {
+      const gf::Vec2I min = position - radius;
+      const gf::Vec2I max = position + radius + 1;
+
+      if (min.x < 0 || min.y < 0 || max.x > WorldSize.x || max.y > WorldSize.y) {
         return false;
       }
 
-      for (const gf::Vec2I neighbor : state.ground.square_range(position, radius)) {
-        if (!state.ground.valid(neighbor) || state.ground(neighbor).region != MapCellBiome::Prairie) {
-          return false;
+      return compute_summed_area(non_prairie, min, max) == 0;
+    }
+
+    /*
+     * The places are put with dart throwing: a random candidate is kept if
+     * the place fits and if it is far enough from the places already kept.
+     * The kept places are stored in a grid whose cells are as large as the
+     * minimum distance, so only the neighboring cells are checked.
+     *
+     * If a place can not be put after MaxPlaceTries candidates, all the
+     * places are tried again, at most MaxPlaceRounds times.
+     */
+
+    constexpr uint32_t MaxPlaceTries = 10000;
+    constexpr uint32_t MaxPlaceRounds = 20;
+
+    class PlaceGrid {
+    public:
+      // min_distance is on the map, the positions are reduced
+      explicit PlaceGrid(int32_t min_distance)
+      : m_min_distance(min_distance)
+      , m_cell_size(std::max((min_distance + ReducedFactor - 1) / ReducedFactor, 1))
+      , m_size(WorldSize / ReducedFactor / m_cell_size + 1)
+      , m_cells(std::size_t(m_size.x) * std::size_t(m_size.y))
+      {
+      }
+
+      void clear()
+      {
+        for (std::vector<gf::Vec2I>& cell : m_cells) {
+          cell.clear();
         }
       }
 
+      void add(gf::Vec2I position)
+      {
+        m_cells[compute_cell_index(position / m_cell_size)].push_back(position);
+      }
+
+      bool is_far_enough(gf::Vec2I position) const
+      {
+        const gf::Vec2I cell = position / m_cell_size;
+
+        for (int32_t j = -1; j <= 1; ++j) {
+          for (int32_t i = -1; i <= 1; ++i) {
+            const gf::Vec2I neighbor = cell + gf::Vec2I(i, j);
+
+            if (neighbor.x < 0 || neighbor.y < 0 || neighbor.x >= m_size.x || neighbor.y >= m_size.y) {
+              continue;
+            }
+
+            for (const gf::Vec2I other : m_cells[compute_cell_index(neighbor)]) {
+              if (gf::manhattan_distance(position, other) * ReducedFactor <= m_min_distance) {
+                return false;
+              }
+            }
+          }
+        }
+
+        return true;
+      }
+
+    private:
+      std::size_t compute_cell_index(gf::Vec2I cell) const
+      {
+        assert(0 <= cell.x && cell.x < m_size.x && 0 <= cell.y && cell.y < m_size.y);
+        return std::size_t(cell.y) * std::size_t(m_size.x) + std::size_t(cell.x);
+      }
+
+      int32_t m_min_distance;
+      int32_t m_cell_size;
+      gf::Vec2I m_size;
+      std::vector<std::vector<gf::Vec2I>> m_cells;
+    };
+
+    template<typename Place, std::size_t Size>
+    bool put_places(std::array<Place, Size>& places, PlaceGrid& grid, const SummedAreaTable& table, int32_t radius, gf::Random* random, PlaceGenerationStats& stats)
+    {
+      constexpr gf::RectI reduced_world_rectangle = gf::RectI::from_size(WorldSize / ReducedFactor);
+
+      for (Place& place : places) {
+        uint32_t tries = 0;
+
+        for (;;) {
+          if (tries == MaxPlaceTries) {
+            return false;
+          }
+
+          ++tries;
+          place.center = random->compute_position(reduced_world_rectangle);
+          ++stats.candidates;
+
+          if (can_have_place(table, to_map(place.center), radius) && grid.is_far_enough(place.center)) {
+            break;
+          }
+
+          ++stats.rejections;
+        }
+
+        grid.add(place.center);
+      }
+
       return true;
     }
 
-    WorldPlaces generate_places(const MapState& state, gf::Random* random)
+    // the terrain may not have enough space for the places, then there is no place
+    void add_place_stats(PlaceGenerationStats& total, const PlaceGenerationStats& stats)
     {
-      constexpr gf::RectI reduced_world_rectangle = gf::RectI::from_size(WorldSize / ReducedFactor);
+      total.candidates += stats.candidates;
+      total.rejections += stats.rejections;
+      total.rounds += stats.rounds;
+    }
+
+    std::optional<WorldPlaces> generate_places(const MapState& state, gf::Random* random, DebugImages& debug, WorldGenerationStats& stats)
+    {
+      const SummedAreaTable table = compute_summed_area_table(state.ground, [](const MapCell& cell) {
+        return cell.region != MapCellBiome::Prairie;
+      });
 
       WorldPlaces places = {};
 
       // first generate towns
 
-      int town_rounds = 0;
+      PlaceGrid town_grid(TownMinDistanceFromOther);
 
       for (;;) {
-        [[maybe_unused]] int tries = 0;
-
-        for (OuterTown& town : places.towns) {
-          do {
-            town.center = random->compute_position(reduced_world_rectangle);
-            ++tries;
-          } while (!can_have_place(state, to_map(town.center), TownRadius + RailSpacing * ReducedFactor));
+        if (stats.towns.rounds == MaxPlaceRounds) {
+          gf::Log::warning("Could not put the towns after {} rounds", stats.towns.rounds);
+          return std::nullopt;
         }
 
-        const int32_t min_distance = places.min_distance_between_towns();
-        // gf::Log::info("Found potential towns after {} tries with min distance {}", tries, min_distance);
-
-        ++town_rounds;
+        ++stats.towns.rounds;
+        town_grid.clear();
 
-        if (min_distance * ReducedFactor > TownMinDistanceFromOther) {
+        if (put_places(places.towns, town_grid, table, TownRadius + RailSpacing * ReducedFactor, random, stats.towns)) {
           break;
         }
       }
 
-      gf::Log::info("Towns generated after {} rounds", town_rounds);
+      assert(places.min_distance_between_towns() * ReducedFactor > TownMinDistanceFromOther);
+
+      gf::Log::info("Towns generated after {} rounds ({} candidates, {} rejected)", stats.towns.rounds, stats.towns.candidates, stats.towns.rejections);
 
       // compute rail arrival/departure
 
@@ -624,28 +1026,28 @@ namespace ffw {
 
       // second generate localities
 
-      int locality_rounds = 0;
+      PlaceGrid locality_grid(LocalityMinDistanceFromOther);
 
       for (;;) {
-        [[maybe_unused]] int tries = 0;
-
-        for (OuterLocality& locality : places.localities) {
-          do {
-            locality.center = random->compute_position(reduced_world_rectangle);
-            ++tries;
-          } while (!can_have_place(state, to_map(locality.center), LocalityRadius));
+        if (stats.localities.rounds == MaxPlaceRounds) {
+          gf::Log::warning("Could not put the localities after {} rounds", stats.localities.rounds);
+          return std::nullopt;
         }
 
-        const int32_t min_distance = places.min_distance_between_towns_and_localities();
-        // gf::Log::info("Found potential locality after {} tries with min distance {}", tries, min_distance);
+        ++stats.localities.rounds;
+        locality_grid.clear();
 
-        ++locality_rounds;
+        for (const OuterTown& town : places.towns) {
+          locality_grid.add(town.center);
+        }
 
-        if (min_distance * ReducedFactor > LocalityMinDistanceFromOther) {
+        if (put_places(places.localities, locality_grid, table, LocalityRadius, random, stats.localities)) {
           break;
         }
       }
 
+      assert(places.min_distance_between_towns_and_localities() * ReducedFactor > LocalityMinDistanceFromOther);
+
       // determine villages
 
       gf::Span<const OuterTown> other_towns(places.towns.data(), places.towns.size());
@@ -673,12 +1075,12 @@ namespace ffw {
         iterator->type = LocalityType::Camp;
       }
 
-      gf::Log::info("Localities generated after {} rounds", locality_rounds);
+      gf::Log::info("Localities generated after {} rounds ({} candidates, {} rejected)", stats.localities.rounds, stats.localities.candidates, stats.localities.rejections);
 
-      if constexpr (Debug) {
+      if (debug.enabled()) {
         gf::Image image = compute_basic_image(state.ground, ImageType::Blocks);
         image = compute_image_add_towns_and_localities(image, places);
-        image.save_to_file("02_places.png");
+        debug.save(std::move(image), "02_places.png");
       }
 
       return places;
@@ -703,32 +1105,86 @@ namespace ffw {
       return image;
     }
 
+    /*
+     * The basic grid is shared by the railway and the road steps. A reduced
+     * cell is walkable if there are few cliffs in the 24 neighbors of its
+     * center on the map.
+     */
+
+    bool is_basic_walkable(const MapState& state, gf::Vec2I position)
+    {
+      int cliffs = 0;
+
+      for (const gf::Vec2I neighbor : state.ground.compute_24_neighbors_range(to_map(position))) {
+        if (state.ground(neighbor).decoration == MapCellDecoration::Cliff) {
+          ++cliffs;
+        }
+      }
+
+      return cliffs <= CliffThreshold;
+    }
+
     gf::GridMap compute_basic_grid(const MapState& state)
     {
+      const SummedAreaTable cliffs = compute_summed_area_table(state.ground, [](const MapCell& cell) {
+        return cell.decoration == MapCellDecoration::Cliff;
+      });
+
       gf::GridMap grid = gf::GridMap::make_orthogonal(WorldSize / ReducedFactor);
 
-      for (const gf::Vec2I position : grid.position_range()) {
-        const gf::Vec2I map_position = to_map(position);
+      parallel_for(std::size_t(grid.size().y), [&](std::size_t row_index) {
+        for (int32_t x = 0; x < grid.size().x; ++x) {
+          const gf::Vec2I position = { x, int32_t(row_index) };
+          const gf::Vec2I map_position = to_map(position);
 
-        int cliffs = 0;
+          // the 5x5 square around the center, inside the map, without the center
+          const gf::Vec2I min = gf::Vec2I(std::max(map_position.x - 2, 0), std::max(map_position.y - 2, 0));
+          const gf::Vec2I max = gf::Vec2I(std::min(map_position.x + 3, WorldSize.x), std::min(map_position.y + 3, WorldSize.y));
+          const uint32_t center = state.ground(map_position).decoration == MapCellDecoration::Cliff ? 1 : 0;
+          const uint32_t count = compute_summed_area(cliffs, min, max) - center;
 
-        for (const gf::Vec2I neighbor : state.ground.compute_24_neighbors_range(map_position)) {
-          if (state.ground(neighbor).decoration == MapCellDecoration::Cliff) {
-            ++cliffs;
-          }
+          grid.set_walkable(position, count <= uint32_t(CliffThreshold));
         }
+      }, 16);
+
+      return grid;
+    }
+
+    // the railway removes the cliffs in its reduced cells, which are seen by the neighbor reduced cells too
+    void update_basic_grid(gf::GridMap& grid, const MapState& state, const NetworkState& network)
+    {
+      std::vector<gf::Vec2I> positions;
 
-        grid.set_walkable(position, cliffs <= CliffThreshold);
+      for (const gf::Vec2I map_position : network.railway) {
+        const gf::Vec2I reduced_position = to_reduced(map_position);
+
+        for (int32_t j = -1; j <= 1; ++j) {
+          for (int32_t i = -1; i <= 1; ++i) {
+            const gf::Vec2I position = reduced_position + gf::Vec2I(i, j);
+
+            if (0 <= position.x && position.x < grid.size().x && 0 <= position.y && position.y < grid.size().y) {
+              positions.push_back(position);
+            }
+          }
+        }
       }
 
-      return grid;
+      std::sort(positions.begin(), positions.end(), [](gf::Vec2I lhs, gf::Vec2I rhs) {
+        return std::tie(lhs.x, lhs.y) < std::tie(rhs.x, rhs.y);
+      });
+
+      positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+
+      for (const gf::Vec2I position : positions) {
+        grid.set_walkable(position, is_basic_walkable(state, position));
+      }
     }
 
-    NetworkState generate_network(const RawWorld& raw, MapState& state, const WorldPlaces& places, gf::Random* random)
+    NetworkState generate_network(const ReducedAltitude& altitude, const gf::GridMap& basic_grid, MapState& state, const WorldPlaces& places, gf::Random* random, DebugImages& debug)
     {
       // initialize the grid
 
-      gf::GridMap grid = compute_basic_grid(state);
+      gf::GridMap grid = basic_grid;
 
       for (const OuterTown& town : places.towns) {
         const gf::RectI town_space = gf::RectI::from_center_size(town.center, { ReducedTownDiameter, ReducedTownDiameter });
@@ -752,7 +1208,7 @@ namespace ffw {
         }
       }
 
-      if constexpr (Debug) {
+      if (debug.enabled()) {
         gf::Image image(grid.size());
 
         for (const gf::Vec2I position : image.position_range()) {
@@ -763,7 +1219,7 @@ namespace ffw {
           }
         }
 
-        image.save_to_file("03_railways_alt.png");
+        debug.save(std::move(image), "03_railways_alt.png");
       }
 
       std::vector<std::vector<gf::Vec2I>> paths;
@@ -784,7 +1240,7 @@ namespace ffw {
 
         const std::size_t j = (i + 1) % places.towns.size();
         auto path = grid.compute_route(places.towns[i].rail_departure, places.towns[j].rail_arrival, [&](gf::Vec2I position, gf::Vec2I neighbor) {
-          return distance_with_slope(raw, position, neighbor);
+          return distance_with_slope(altitude, position, neighbor);
         });
 
         for (const gf::Vec2I point : path) {
@@ -796,7 +1252,7 @@ namespace ffw {
         }
 
         assert(!path.empty());
-        gf::Log::info("Points between {} and {}: {}", i, j, path.size());
+        FFW_LOG_DEBUG("Points between {} and {}: {}", i, j, path.size());
 
         paths.push_back(std::move(path));
       }
@@ -868,11 +1324,11 @@ namespace ffw {
         }
       }
 
-      if constexpr (Debug) {
+      if (debug.enabled()) {
         gf::Image image = compute_basic_image(state.ground, ImageType::Blocks);
         image = compute_image_add_towns_and_localities(image, places);
         image = compute_image_add_network(image, network);
-        image.save_to_file("03_railways.png");
+        debug.save(std::move(image), "03_railways.png");
       }
 
       gf::Log::info("Railway length: {}", network.railway.size() * ReducedFactor);
@@ -886,9 +1342,114 @@ namespace ffw {
      *
      */
 
-    void generate_roads(const RawWorld& raw, const MapState& state, NetworkState& network, const WorldPlaces& places)
+    /*
+     * A Dijkstra search from an origin that stops when all the targets are
+     * reached, so that all the roads from a place are computed at once. The
+     * grid is orthogonal, the routes go through walkable cells and contain
+     * the origin and the target.
+     */
+
+    struct RoadSearch {
+      gf::Vec2I origin;
+      std::vector<gf::Vec2I> targets;
+    };
+
+    template<typename Cost>
+    std::vector<gf::Vec2I> compute_roads_to_targets(const gf::GridMap& grid, const RoadSearch& search, Cost cost)
     {
-      gf::GridMap grid = compute_basic_grid(state);
+      const gf::Vec2I size = grid.size();
+
+      auto to_index = [size](gf::Vec2I position) {
+        return uint32_t(position.y) * uint32_t(size.x) + uint32_t(position.x);
+      };
+
+      auto to_position = [size](uint32_t index) {
+        return gf::Vec2I(int32_t(index % uint32_t(size.x)), int32_t(index / uint32_t(size.x)));
+      };
+
+      std::vector<float> distances(std::size_t(size.x) * std::size_t(size.y), std::numeric_limits<float>::infinity());
+      std::vector<uint32_t> parents(distances.size(), NoIndex);
+      std::vector<bool> settled(distances.size(), false);
+      std::vector<bool> is_target(distances.size(), false);
+
+      std::size_t remaining = 0;
+
+      for (const gf::Vec2I target : search.targets) {
+        if (!is_target[to_index(target)]) {
+          is_target[to_index(target)] = true;
+          ++remaining;
+        }
+      }
+
+      using Entry = std::pair<float, uint32_t>;
+      std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+
+      const uint32_t origin_index = to_index(search.origin);
+      distances[origin_index] = 0.0f;
+      queue.push({ 0.0f, origin_index });
+
+      constexpr gf::Vec2I FourNeighbors[] = {
+        { 0, -1 }, { -1, 0 }, { +1, 0 }, { 0, +1 }
+      };
+
+      while (!queue.empty() && remaining > 0) {
+        const auto [ distance, index ] = queue.top();
+        queue.pop();
+
+        if (settled[index]) {
+          continue;
+        }
+
+        settled[index] = true;
+
+        if (is_target[index]) {
+          --remaining;
+        }
+
+        const gf::Vec2I position = to_position(index);
+
+        for (const gf::Vec2I relative_neighbor : FourNeighbors) {
+          const gf::Vec2I neighbor = position + relative_neighbor;
+
+          if (neighbor.x < 0 || neighbor.y < 0 || neighbor.x >= size.x || neighbor.y >= size.y || !grid.walkable(neighbor)) {
+            continue;
+          }
+
+          const uint32_t neighbor_index = to_index(neighbor);
+          const float neighbor_distance = distance + cost(position, neighbor);
+
+          if (!settled[neighbor_index] && neighbor_distance < distances[neighbor_index]) {
+            distances[neighbor_index] = neighbor_distance;
+            parents[neighbor_index] = index;
+            queue.push({ neighbor_distance, neighbor_index });
+          }
+        }
+      }
+
+      std::vector<gf::Vec2I> roads;
+
+      for (const gf::Vec2I target : search.targets) {
+        uint32_t index = to_index(target);
+
+        if (!settled[index]) {
+          continue; // not reachable
+        }
+
+        while (index != origin_index) {
+          roads.push_back(to_position(index));
+          index = parents[index];
+          assert(index != NoIndex);
+        }
+
+        roads.push_back(search.origin);
+      }
+
+      return roads;
+    }
+
+    void generate_roads(const ReducedAltitude& altitude, const gf::GridMap& basic_grid, const MapState& state, NetworkState& network, const WorldPlaces& places, DebugImages& debug)
+    {
+      gf::GridMap grid = basic_grid;
 
       for (const OuterTown& town : places.towns) {
         const gf::RectI town_space = gf::RectI::from_center_size(town.center, { ReducedTownDiameter, ReducedTownDiameter });
@@ -914,7 +1475,7 @@ namespace ffw {
       std::vector<gf::Vec2I> roads;
 
       const auto distance_function = [&](gf::Vec2I position, gf::Vec2I neighbor) {
-        const float distance = distance_with_slope(raw, position, neighbor);
+        const float distance = distance_with_slope(altitude, position, neighbor);
 
         if (grid.blocked(neighbor)) {
           if (grid.blocked(position)) {
@@ -931,7 +1492,11 @@ namespace ffw {
         return std::tie(lhs.x, lhs.y) < std::tie(rhs.x, rhs.y);
       };
 
+      std::vector<RoadSearch> searches;
+
       for (const OuterLocality& from : places.localities) {
+        RoadSearch search = { from.center, {} };
+
         for (const OuterLocality& to : places.localities) {
           if (from.center == to.center) {
             continue;
@@ -945,12 +1510,17 @@ namespace ffw {
             continue;
           }
 
-          const std::vector<gf::Vec2I> road = grid.compute_route(from.center, to.center, distance_function);
-          roads.insert(roads.end(), road.begin(), road.end());
+          search.targets.push_back(to.center);
+        }
+
+        if (!search.targets.empty()) {
+          searches.push_back(std::move(search));
         }
       }
 
       for (const OuterTown& from : places.towns) {
+        RoadSearch search = { from.center, {} };
+
         for (const OuterLocality& to : places.localities) {
           if (from.center == to.center) {
             continue;
@@ -960,11 +1530,26 @@ namespace ffw {
             continue;
           }
 
-          const std::vector<gf::Vec2I> road = grid.compute_route(from.center, to.center, distance_function);
-          roads.insert(roads.end(), road.begin(), road.end());
+          search.targets.push_back(to.center);
+        }
+
+        if (!search.targets.empty()) {
+          searches.push_back(std::move(search));
         }
       }
 
+      // the grid is only read during the searches
+
+      std::vector<std::vector<gf::Vec2I>> search_roads(searches.size());
+
+      parallel_for(searches.size(), [&](std::size_t i) {
+        search_roads[i] = compute_roads_to_targets(grid, searches[i], distance_function);
+      }, 1);
+
+      for (const std::vector<gf::Vec2I>& search_road : search_roads) {
+        roads.insert(roads.end(), search_road.begin(), search_road.end());
+      }
+
       std::sort(roads.begin(), roads.end(), position_comparator);
 
       roads.erase(std::unique(roads.begin(), roads.end()), roads.end());
@@ -993,11 +1578,11 @@ namespace ffw {
         network.roads.push_back(to_map(position));
       }
 
-      if constexpr (Debug) {
+      if (debug.enabled()) {
         gf::Image image = compute_basic_image(state.ground, ImageType::Blocks);
         image = compute_image_add_towns_and_localities(image, places);
         image = compute_image_add_network(image, network);
-        image.save_to_file("04_roads.png");
+        debug.save(std::move(image), "04_roads.png");
       }
     }
 
@@ -1140,9 +1725,32 @@ namespace ffw {
      * in the following steps.
      */
 
+    // a horizontal run of cells of the same biome
+    struct RegionSpan {
+      int32_t x;
+      int32_t y;
+      uint32_t length;
+      uint32_t offset; // number of cells in the previous spans of the region
+    };
+
     struct WorldRegion {
-      std::vector<gf::Vec2I> points;
+      uint32_t label = 0;
+      uint32_t size = 0;
       gf::RectI bounds;
+      std::vector<RegionSpan> spans; // in row order
+
+      // the index-th cell of the region, in row order
+      gf::Vec2I compute_point(uint32_t index) const
+      {
+        assert(index < size);
+        auto iterator = std::upper_bound(spans.begin(), spans.end(), index, [](uint32_t value, const RegionSpan& span) {
+          return value < span.offset;
+        });
+        assert(iterator != spans.begin());
+        --iterator;
+        assert(index - iterator->offset < iterator->length);
+        return { iterator->x + int32_t(index - iterator->offset), iterator->y };
+      }
     };
 
     struct WorldRegions {
@@ -1172,84 +1780,167 @@ namespace ffw {
       }
     };
 
+    /*
+     * The regions are labeled with a union-find on the runs of each row. The
+     * rows are split in bands that are processed in parallel, then the
+     * bands are joined. The root of a region is always its first run so the
+     * labels are in the order of the rows, whatever the number of threads.
+     */
+
+    constexpr int32_t RegionBandSize = 64;
+
+    struct RegionRun {
+      int32_t x;
+      uint32_t length;
+      MapCellBiome biome;
+    };
+
     WorldRegions compute_regions(const MapState& state)
     {
-      enum class Status : uint8_t {
-        New,
-        Visited,
-      };
+      // runs of each row
 
-      gf::Array2D<Status> status(WorldSize, Status::New);
+      std::vector<std::vector<RegionRun>> row_runs(std::size_t(WorldSize.y));
 
-      WorldRegions regions = {};
+      parallel_for(row_runs.size(), [&](std::size_t row_index) {
+        const int32_t y = int32_t(row_index);
+        std::vector<RegionRun>& runs = row_runs[row_index];
 
-      for (const gf::Vec2I position : state.ground.position_range()) {
-        if (status(position) == Status::Visited) {
-          continue;
+        for (int32_t x = 0; x < WorldSize.x; ) {
+          const MapCellBiome biome = state.ground({ x, y }).region;
+          const int32_t start = x;
+
+          while (x < WorldSize.x && state.ground({ x, y }).region == biome) {
+            ++x;
+          }
+
+          runs.push_back({ start, uint32_t(x - start), biome });
         }
+      }, RegionBandSize);
 
-        const MapCellBiome region_type = state.ground(position).region;
+      std::vector<uint32_t> row_offsets(row_runs.size() + 1, 0);
 
-        std::queue<gf::Vec2I> queue;
-        queue.emplace(position);
-        status(position) = Status::Visited;
+      for (std::size_t y = 0; y < row_runs.size(); ++y) {
+        row_offsets[y + 1] = row_offsets[y] + uint32_t(row_runs[y].size());
+      }
 
-        WorldRegion region;
+      // union-find on the runs, the root is always the smallest index
 
-        while (!queue.empty()) {
-          const gf::Vec2I current = queue.front();
-          queue.pop();
-          assert(status(current) == Status::Visited);
-          region.points.push_back(current);
+      std::vector<uint32_t> parents(row_offsets.back());
 
-          for (const gf::Vec2I neighbor : state.ground.compute_4_neighbors_range(current)) {
-            if (status(neighbor) == Status::Visited) {
-              continue;
-            }
+      for (uint32_t i = 0; i < parents.size(); ++i) {
+        parents[i] = i;
+      }
+
+      auto find = [&parents](uint32_t run) {
+        while (parents[run] != run) {
+          parents[run] = parents[parents[run]];
+          run = parents[run];
+        }
+
+        return run;
+      };
+
+      auto join_rows = [&](int32_t y) {
+        assert(y > 0);
+        const std::vector<RegionRun>& prev_runs = row_runs[std::size_t(y - 1)];
+        const std::vector<RegionRun>& curr_runs = row_runs[std::size_t(y)];
+        std::size_t j = 0;
+
+        for (std::size_t i = 0; i < curr_runs.size(); ++i) {
+          const RegionRun& curr = curr_runs[i];
+          const int32_t curr_end = curr.x + int32_t(curr.length);
 
-            if (state.ground(neighbor).region != region_type) {
+          while (j < prev_runs.size() && prev_runs[j].x + int32_t(prev_runs[j].length) <= curr.x) {
+            ++j;
+          }
+
+          for (std::size_t k = j; k < prev_runs.size() && prev_runs[k].x < curr_end; ++k) {
+            if (prev_runs[k].biome != curr.biome) {
               continue;
             }
 
-            status(neighbor) = Status::Visited;
-            queue.push(neighbor);
+            const uint32_t root_prev = find(row_offsets[std::size_t(y - 1)] + uint32_t(k));
+            const uint32_t root_curr = find(row_offsets[std::size_t(y)] + uint32_t(i));
+
+            if (root_prev < root_curr) {
+              parents[root_curr] = root_prev;
+            } else if (root_curr < root_prev) {
+              parents[root_prev] = root_curr;
+            }
           }
         }
+      };
 
-        if (region.points.size() > RegionMinimumSize) {
-          regions(region_type).push_back(std::move(region));
-        }
-      }
+      const std::size_t band_count = std::size_t((WorldSize.y + RegionBandSize - 1) / RegionBandSize);
+
+      // in a band, the runs only refer to runs of the same band
+
+      parallel_for(band_count, [&](std::size_t band) {
+        const int32_t band_start = int32_t(band) * RegionBandSize;
+        const int32_t band_end = std::min(band_start + RegionBandSize, WorldSize.y);
 
-      // compute region bounds
+        for (int32_t y = band_start + 1; y < band_end; ++y) {
+          join_rows(y);
+        }
+      }, 1);
 
-      auto compute_bounds = [](std::vector<WorldRegion>& regions, std::string_view name) {
+      for (std::size_t band = 1; band < band_count; ++band) {
+        join_rows(int32_t(band) * RegionBandSize);
+      }
 
-        for (WorldRegion& region : regions) {
-          gf::RectI bounds = gf::RectI::from_center_size(region.points.front(), { 1, 1 });
+      // regions
 
-          for (gf::Vec2I point : region.points) {
-            bounds.extend_to(point);
+      WorldRegions regions = {};
+      std::vector<WorldRegion> all_regions;
+      std::vector<uint32_t> run_labels(parents.size());
+
+      for (int32_t y = 0; y < WorldSize.y; ++y) {
+        for (const auto& [ i, run ] : gf::enumerate(row_runs[std::size_t(y)])) {
+          const uint32_t run_index = row_offsets[std::size_t(y)] + uint32_t(i);
+          const uint32_t root = find(run_index);
+
+          if (root == run_index) {
+            WorldRegion region;
+            region.label = uint32_t(all_regions.size());
+            region.bounds = gf::RectI::from_center_size({ run.x, y }, { 1, 1 });
+            all_regions.push_back(std::move(region));
+            run_labels[run_index] = all_regions.back().label;
+          } else {
+            assert(root < run_index);
+            run_labels[run_index] = run_labels[root];
           }
 
-          region.bounds = bounds;
+          WorldRegion& region = all_regions[run_labels[run_index]];
+          region.spans.push_back({ run.x, y, run.length, region.size });
+          region.size += run.length;
+          region.bounds.extend_to({ run.x, y });
+          region.bounds.extend_to({ run.x + int32_t(run.length) - 1, y });
+        }
+      }
+
+      for (WorldRegion& region : all_regions) {
+        if (region.size > RegionMinimumSize) {
+          const RegionSpan& first = region.spans.front();
+          regions(state.ground({ first.x, first.y }).region).push_back(std::move(region));
         }
+      }
 
-        std::sort(regions.begin(), regions.end(), [](const WorldRegion& lhs, const WorldRegion& rhs) {
-          return lhs.points.size() > rhs.points.size();
+      auto sort_regions = [](std::vector<WorldRegion>& biome_regions, std::string_view name) {
+        std::sort(biome_regions.begin(), biome_regions.end(), [](const WorldRegion& lhs, const WorldRegion& rhs) {
+          return lhs.size > rhs.size;
         });
 
-        gf::Log::info("\t{} ({})", name, regions.size());
+        gf::Log::info("\t{} ({})", name, biome_regions.size());
 
-        // for (WorldRegion& region : regions) {
-        //   gf::Log::info("\t\t- Size: {}, Extent: {}x{}, Density: {:g}", region.points.size(), region.bounds.extent.w, region.bounds.extent.h, double(region.points.size()) / double(region.bounds.extent.w * region.bounds.extent.h));
+        // for (WorldRegion& region : biome_regions) {
+        //   gf::Log::info("\t\t- Size: {}, Extent: {}x{}, Density: {:g}", region.size, region.bounds.extent.w, region.bounds.extent.h, double(region.size) / double(region.bounds.extent.w * region.bounds.extent.h));
         // }
       };
 
-      compute_bounds(regions.prairie_regions, "Prairie");
-      compute_bounds(regions.desert_regions, "Desert");
-      compute_bounds(regions.forest_regions, "Forest");
-      compute_bounds(regions.mountain_regions, "Moutain");
+      sort_regions(regions.prairie_regions, "Prairie");
+      sort_regions(regions.desert_regions, "Desert");
+      sort_regions(regions.forest_regions, "Forest");
+      sort_regions(regions.mountain_regions, "Moutain");
 
       return regions;
     }
@@ -1306,8 +1997,7 @@ namespace ffw {
     CaveAccess compute_underground_cave_access(MapState& state, const WorldRegion& region, gf::Random* random)
     {
       for (;;) {
-        const std::size_t index = random->compute_uniform_integer(region.points.size());
-        const gf::Vec2I entrance = region.points[index];
+        const gf::Vec2I entrance = region.compute_point(random->compute_uniform_integer(region.size));
 
         if (is_on_side(entrance) || state.ground(entrance).decoration != MapCellDecoration::Cliff) {
           continue;
@@ -1325,7 +2015,7 @@ namespace ffw {
 
     std::vector<CaveAccess> compute_underground_cave_accesses(MapState& state, const WorldRegion& region, gf::Random* random)
     {
-      std::size_t access_count = 1 + region.points.size() / SurfacePerCave;
+      std::size_t access_count = 1 + region.size / SurfacePerCave;
       std::vector<CaveAccess> accesses(access_count);
 
       std::size_t tries = 0;
@@ -1432,7 +2122,7 @@ namespace ffw {
       }
     }
 
-    void compute_underground(MapState& state, const WorldRegions& regions, gf::Random* random)
+    void compute_underground(MapState& state, const WorldRegions& regions, gf::Random* random, DebugImages& debug)
     {
       state.underground = { WorldSize, { MapCellBiome::Underground, MapCellProperty::None, MapCellDecoration::Rock } };
 
@@ -1492,16 +2182,16 @@ namespace ffw {
         }
       }
 
-      if constexpr (Debug) {
+      if (debug.enabled()) {
         gf::Image image = compute_basic_image(state.ground, ImageType::Blocks);
         // image = compute_image_add_towns_and_localities(image, places);
         // image = compute_image_add_railways(image, network);
         image = compute_image_add_cave_accesses(image, state);
-        image.save_to_file("06_accesses.png");
+        debug.save(std::move(image), "06_accesses.png");
 
         gf::Image underground_image = compute_basic_image(state.underground, ImageType::Blocks);
         underground_image = compute_underground_image_add_cave_accesses(underground_image, state);
-        underground_image.save_to_file("06_access_underground.png");
+        debug.save(std::move(underground_image), "06_access_underground.png");
       }
 
     }
@@ -1522,6 +2212,52 @@ namespace ffw {
       return position + 2 * gf::sign(position - center);
     }
 
+    /*
+     * Each step has its own random generator, seeded from the world seed, so
+     * that a step does not change the random numbers of the next steps.
+     */
+
+    enum class WorldStream : uint32_t {
+      Date,
+      Raw,
+      Outline,
+      Mountains,
+      Places,
+      Network,
+      Towns,
+      Localities,
+      Underground,
+      Hero,
+      Herds,
+    };
+
+    gf::Random compute_stream_random(uint64_t seed, WorldStream stream)
+    {
+      return gf::Random(compute_task_seed(seed, static_cast<uint32_t>(stream)));
+    }
+
+    std::optional<gf::Vec2I> compute_herd_home(const MapState& state, gf::Vec2I farm, gf::Random* random)
+    {
+      for (int tries = 0; tries < MaxHerdHomeTries; ++tries) {
+        const float radius = random->compute_radius(float(HerdMinDistanceFromFarm), float(HerdMaxDistanceFromFarm));
+        const float angle = random->compute_angle();
+        const gf::Vec2I offset = radius * gf::unit(angle);
+        const gf::Vec2I home = farm + offset;
+
+        if (!state.ground.valid(home)) {
+          continue;
+        }
+
+        const MapCell& cell = state.ground(home);
+
+        if (cell.region == MapCellBiome::Prairie && is_walkable(cell.decoration)) {
+          return home;
+        }
+      }
+
+      return std::nullopt;
+    }
+
     Gender generate_gender(gf::Random* random)
     {
       std::discrete_distribution distribution({ 50.0, 48.0, 2.0 });
@@ -1544,42 +2280,96 @@ namespace ffw {
 
   }
 
-  WorldState generate_world(gf::Random* random, std::atomic<WorldGenerationStep>& step)
+  uint64_t generate_world_seed(gf::Random* random)
+  {
+    std::uniform_int_distribution<uint64_t> distribution;
+    return distribution(random->engine());
+  }
+
+  std::optional<WorldState> generate_world(uint64_t seed, std::atomic<WorldGenerationStep>& step, const WorldGenerationSettings& settings, WorldGenerationStats* stats)
   {
     gf::Clock clock;
+    DebugImages debug(settings.debug_images);
 
     WorldState state = {};
-    step.store(WorldGenerationStep::Date);
-    state.current_date = Date::generate_random(random);
+    ReducedAltitude altitude;
+    WorldPlaces places;
+    WorldGenerationStats generation_stats;
 
     gf::Log::info("Starting generation...");
-    step.store(WorldGenerationStep::Terrain);
-    const RawWorld raw = generate_raw(random);
-    gf::Log::info("- raw ({:g}s)", clock.elapsed_time().as_seconds());
 
-    step.store(WorldGenerationStep::Biomes);
-    state.map = generate_outline(raw, random);
-    gf::Log::info("- outline ({:g}s)", clock.elapsed_time().as_seconds());
+    for (;;) {
+      if (generation_stats.terrains == MaxTerrainAttempts) {
+        gf::Log::error("The places do not fit on {} terrains, the world can not be generated", generation_stats.terrains);
+
+        if (stats != nullptr) {
+          *stats = generation_stats;
+        }
 
-    step.store(WorldGenerationStep::Moutains);
-    generate_mountains(state.map, random);
-    gf::Log::info("- moutains ({:g}s)", clock.elapsed_time().as_seconds());
+        return std::nullopt;
+      }
 
-    step.store(WorldGenerationStep::Towns);
-    const WorldPlaces places = generate_places(state.map, random);
-    gf::Log::info("- places ({:g}s)", clock.elapsed_time().as_seconds());
+      ++generation_stats.terrains;
+      gf::Log::info("Seed: {}", seed);
+
+      step.store(WorldGenerationStep::Terrain);
+      gf::Random raw_random = compute_stream_random(seed, WorldStream::Raw);
+      RawWorld raw = generate_raw(&raw_random);
+      gf::Log::info("- raw ({:g}s)", clock.elapsed_time().as_seconds());
+
+      step.store(WorldGenerationStep::Biomes);
+      gf::Random outline_random = compute_stream_random(seed, WorldStream::Outline);
+      state.map = generate_outline(raw, &outline_random, debug);
+      altitude = compute_reduced_altitude(raw);
+      raw = RawWorld(); // the full resolution is not needed anymore
+      gf::Log::info("- outline ({:g}s)", clock.elapsed_time().as_seconds());
+
+      step.store(WorldGenerationStep::Moutains);
+      gf::Random mountains_random = compute_stream_random(seed, WorldStream::Mountains);
+      generate_mountains(state.map, &mountains_random, debug);
+      gf::Log::info("- moutains ({:g}s)", clock.elapsed_time().as_seconds());
+
+      step.store(WorldGenerationStep::Towns);
+      gf::Random places_random = compute_stream_random(seed, WorldStream::Places);
+
+      // the rounds are limited for each terrain, the stats are added for all the terrains
+      WorldGenerationStats terrain_stats;
+      std::optional<WorldPlaces> maybe_places = generate_places(state.map, &places_random, debug, terrain_stats);
+      add_place_stats(generation_stats.towns, terrain_stats.towns);
+      add_place_stats(generation_stats.localities, terrain_stats.localities);
+
+      if (maybe_places) {
+        places = *maybe_places;
+        gf::Log::info("- places ({:g}s)", clock.elapsed_time().as_seconds());
+        break;
+      }
+
+      // the terrain is not suitable, start again with another seed (the world can still be generated again from the saved seed)
+      seed = SplitMix64(seed).compute_next();
+      gf::Log::warning("The places do not fit on terrain {}/{}, generating another terrain", generation_stats.terrains, MaxTerrainAttempts);
+    }
+
+    state.seed = seed;
+
+    gf::Random date_random = compute_stream_random(seed, WorldStream::Date);
+    state.current_date = Date::generate_random(&date_random);
 
     step.store(WorldGenerationStep::Rails);
-    state.network = generate_network(raw, state.map, places, random);
+    gf::GridMap basic_grid = compute_basic_grid(state.map);
+    gf::Random network_random = compute_stream_random(seed, WorldStream::Network);
+    state.network = generate_network(altitude, basic_grid, state.map, places, &network_random, debug);
     gf::Log::info("- network ({:g}s)", clock.elapsed_time().as_seconds());
 
     // TODO: step
-    generate_roads(raw, state.map, state.network, places);
+    update_basic_grid(basic_grid, state.map, state.network);
+    generate_roads(altitude, basic_grid, state.map, state.network, places, debug);
     gf::Log::info("- roads ({:g}s)", clock.elapsed_time().as_seconds());
 
     step.store(WorldGenerationStep::Buildings);
-    generate_towns(state.map, places, random);
-    generate_localities(state.map, places, random);
+    gf::Random towns_random = compute_stream_random(seed, WorldStream::Towns);
+    generate_towns(state.map, places, &towns_random);
+    gf::Random localities_random = compute_stream_random(seed, WorldStream::Localities);
+    generate_localities(state.map, places, &localities_random);
     gf::Log::info("- towns and localities ({:g}s)", clock.elapsed_time().as_seconds());
 
     step.store(WorldGenerationStep::Regions);
@@ -1587,7 +2377,8 @@ namespace ffw {
     gf::Log::info("- regions ({:g}s)", clock.elapsed_time().as_seconds());
 
     step.store(WorldGenerationStep::Underground);
-    compute_underground(state.map, regions, random);
+    gf::Random underground_random = compute_stream_random(seed, WorldStream::Underground);
+    compute_underground(state.map, regions, &underground_random, debug);
     gf::Log::info("- underground ({:g}s)", clock.elapsed_time().as_seconds());
 
     step.store(WorldGenerationStep::Hero);
@@ -1598,47 +2389,53 @@ namespace ffw {
 
     compute_hero_fov(hero.position, state.map.ground);
 
-    HumanFeature human;
-    human.gender = generate_gender(random);
+    gf::Random hero_random = compute_stream_random(seed, WorldStream::Hero);
+
+    HumanState human = {};
+    human.gender = generate_gender(&hero_random);
 
     switch (human.gender) {
       case Gender::Girl:
-        human.name = generate_random_white_female_name(random);
+        human.name = generate_random_white_female_name(&hero_random);
         break;
       case Gender::Boy:
-        human.name = generate_random_white_male_name(random);
+        human.name = generate_random_white_male_name(&hero_random);
         break;
       case Gender::NonBinary:
-        human.name = generate_random_white_non_binary_name(random);
+        human.name = generate_random_white_non_binary_name(&hero_random);
         break;
     }
 
-    human.age = random->compute_uniform_integer<int8_t>(20, 40);
-    human.birthday = generate_random_birthday(random);
+    human.age = hero_random.compute_uniform_integer<int8_t>(20, 40);
+    human.birthday = generate_random_birthday(&hero_random);
 
     human.health = MaxHealth - 1;
 
-    human.force = generate_attribute(random);
-    human.dexterity = generate_attribute(random);
-    human.constitution = generate_attribute(random);
-    human.luck = generate_attribute(random);
+    human.force = generate_attribute(&hero_random);
+    human.dexterity = generate_attribute(&hero_random);
+    human.constitution = generate_attribute(&hero_random);
+    human.luck = generate_attribute(&hero_random);
 
     human.intensity = 100;
     human.precision = 90;
     human.endurance = 70;
 
-    hero.feature = human;
-
-    hero.weapon.data = "Colt Dragoon Revolver";
-    hero.weapon.cartridges = 0;
+    human.weapon.data = "Colt Dragoon Revolver";
+    human.weapon.cartridges = 0;
 
-    hero.ammunition.data = ".44 Ammunitions";
-    hero.ammunition.count = 32;
+    human.ammunition.data = ".44 Ammunitions";
+    human.ammunition.count = 32;
 
     gf::Log::info("Name: {} (Luck: {})", human.name, human.luck);
 
+    HumanFeature hero_feature;
+    hero_feature.human = uint32_t(state.humans.size());
+    hero.feature = hero_feature;
+
+    state.humans.push_back(human);
+
     state.actors.push_back(hero);
-    state.scheduler.queue.push({state.current_date, TaskType::Actor, 0});
+    state.scheduler.push({state.current_date, TaskType::Actor, 0});
 
     step.store(WorldGenerationStep::Actors);
 
@@ -1655,19 +2452,59 @@ namespace ffw {
 
       Date cow_next_turn = state.current_date;
       cow_next_turn.add_seconds(1);
-      state.scheduler.queue.push({cow_next_turn, TaskType::Actor, 1});
+      state.scheduler.push({cow_next_turn, TaskType::Actor, 1});
     }
 
+    gf::Random herds_random = compute_stream_random(seed, WorldStream::Herds);
+    std::vector<Task> herd_tasks;
+
+    for (const LocalityState& locality : state.map.localities) {
+      if (locality.type != LocalityType::Farm) {
+        continue;
+      }
+
+      for (std::size_t i = 0; i < HerdsPerFarm; ++i) {
+        const std::optional<gf::Vec2I> home = compute_herd_home(state.map, locality.position, &herds_random);
+
+        if (!home) {
+          continue;
+        }
+
+        HerdState herd = {};
+        herd.data = "Cow";
+        herd.home = herd.center = *home;
+        herd.count = static_cast<uint8_t>(HerdMinSize + herds_random.compute_uniform_integer(HerdMaxSize - HerdMinSize + 1));
+        herd.date = state.current_date;
+
+        const uint32_t herd_index = uint32_t(state.population.herds.size());
+        state.population.herds.push_back(std::move(herd));
+
+        Date date = state.current_date;
+        date.add_seconds(static_cast<uint16_t>(1 + herds_random.compute_uniform_integer(HerdTime)));
+        herd_tasks.push_back({ date, TaskType::Herd, herd_index });
+      }
+    }
+
+    state.scheduler.schedule_many(herd_tasks);
+
+    gf::Log::info("Herds: {}", state.population.herds.size());
+
     for (const auto& [ index, train ] : gf::enumerate(state.network.trains)) {
+      state.network.trains[index].reference = state.current_date;
+
       Date date = state.current_date;
       date.add_seconds(state.network.stations[index].stop_time);
-      state.scheduler.queue.push({ date, TaskType::Train, uint32_t(index) } );
+      state.scheduler.push({ date, TaskType::Train, uint32_t(index) } );
     }
 
     state.add_message(fmt::format("Hello <style=character>{}</>!", human.name));
 
     gf::Log::info("- actors ({:g}s)", clock.elapsed_time().as_seconds());
 
+    if (stats != nullptr) {
+      *stats = generation_stats;
+    }
+
     step.store(WorldGenerationStep::End);
     return state;
   }
@@ -1,7 +1,10 @@
 #ifndef FFW_WORLD_GENERATION_H
 #define FFW_WORLD_GENERATION_H
 
+#include <cstdint>
+
 #include <atomic>
+#include <optional>
 
 #include <gf2/core/Random.h>
 
@@ -10,7 +13,27 @@
 
 namespace ffw {
 
-  WorldState generate_world(gf::Random* random, std::atomic<WorldGenerationStep>& step);
+  struct WorldGenerationSettings {
+    bool debug_images = false; // save an image after each step, in the current directory
+  };
+
+  struct PlaceGenerationStats {
+    uint32_t candidates = 0; // positions tried
+    uint32_t rejections = 0; // positions where the place does not fit
+    uint32_t rounds = 0; // sets of places tried until they are far enough from each other
+  };
+
+  struct WorldGenerationStats {
+    uint32_t terrains = 0; // terrains generated, more than one if the places did not fit
+    PlaceGenerationStats towns; // for all the terrains
+    PlaceGenerationStats localities; // for all the terrains
+  };
+
+  uint64_t generate_world_seed(gf::Random* random);
+
+  // the same seed gives the same world, state.seed is another seed if the terrain of the first one was not suitable
+  // nothing if no terrain was suitable after a few seeds
+  std::optional<WorldState> generate_world(uint64_t seed, std::atomic<WorldGenerationStep>& step, const WorldGenerationSettings& settings = {}, WorldGenerationStats* stats = nullptr);
 
 }
 
@@ -3,13 +3,22 @@
 #include <cassert>
 #include <cstdint>
 
+#include <algorithm>
+#include <optional>
+
+#include <gf2/core/Clock.h>
+
 #include "ActorData.h"
 #include "ActorState.h"
+#include "DormancyState.h"
 #include "Index.h"
+#include "Logging.h"
 #include "MapCell.h"
 #include "MapRuntime.h"
 #include "MapState.h"
+#include "Parallel.h"
 #include "SchedulerState.h"
+#include "SchedulerStats.h"
 #include "Times.h"
 #include "WorldGenerationStep.h"
 
@@ -20,10 +29,25 @@ namespace ffw {
     constexpr gf::Time Cooldown = gf::milliseconds(20);
 
     constexpr int32_t IdleDistance = 100;
+    constexpr int32_t DormancyChunkDistance = 4;
+    static_assert(IdleDistance < DormancyChunkDistance * DormancyChunkSize);
+
+    constexpr uint64_t MaxCatchUpMoves = 10;
+
+    constexpr int32_t TrainWakeDistance = IdleDistance;
+    constexpr int32_t TrainSleepDistance = IdleDistance + 50;
+
+    constexpr int32_t HerdSpread = 5;
+    constexpr int32_t HerdRoamingRadius = 50;
+    constexpr int MaxHerdPlacementTries = 20;
+    constexpr double HerdChangeProbability = 0.05;
 
     constexpr int MaxMoveTries = 10;
 
-    gf::Orientation random_orientation(gf::Random* random) {
+    // a batch has a few dozen cows, a cow move is a few map lookups
+    constexpr std::size_t GrazingMinCountPerThread = 16;
+
+    gf::Orientation random_orientation(SplitMix64& generator) {
       constexpr gf::Orientation Orientations[] = {
         gf::Orientation::Center,
         gf::Orientation::North,
@@ -36,7 +60,7 @@ namespace ffw {
         gf::Orientation::NorthWest,
       };
 
-      const std::size_t index = random->compute_uniform_integer(std::size(Orientations));
+      const std::size_t index = generator.compute_uniform_integer(uint32_t(std::size(Orientations)));
       assert(index < std::size(Orientations));
       return Orientations[index];
     }
@@ -83,6 +107,10 @@ namespace ffw {
     step.store(WorldGenerationStep::Data);
     state.bind(data);
     runtime.bind(data, state, m_random, step);
+
+    m_hero_chunk = { -1, -1 };
+    update_hero_chunk();
+    wake_trains();
   }
 
   void WorldModel::update(gf::Time time)
@@ -99,10 +127,15 @@ namespace ffw {
     }
 
     update_date();
+    update_hero_chunk();
+    wake_trains();
+
+    SchedulerStats& stats = runtime.scheduler_stats;
+    stats.start_frame();
 
     bool need_cooldown = false;
 
-    while (state.current_date == state.scheduler.queue.top().date) {
+    while (state.current_date == state.scheduler.top().date) {
       if (state.scheduler.is_hero_turn()) {
         if (update_hero()) {
           need_cooldown = true;
@@ -111,29 +144,30 @@ namespace ffw {
         break;
       }
 
-      const Task& current_task = state.scheduler.queue.top();
+      gf::Clock clock;
 
-      if (current_task.type == TaskType::Actor) {
-        assert(current_task.index < state.actors.size());
-        gf::Log::debug("[SCHEDULER] {}: Update actor {}", state.current_date.to_string(), current_task.index);
+      if (is_grazing_turn(state.scheduler.top())) {
+        update_grazing_cows();
+        stats.add_tasks(TaskType::Actor, m_grazing_cows.size(), clock.elapsed_time());
+        need_cooldown = true;
+        continue;
+      }
 
-        if (update_actor(state.actors[current_task.index])) {
-          need_cooldown = true;
-        }
+      const TaskType type = state.scheduler.top().type;
 
-        continue;
+      if (update_task()) {
+        need_cooldown = true;
       }
 
-      if (current_task.type == TaskType::Train) {
-        assert(current_task.index < state.network.trains.size());
-        gf::Log::debug("[SCHEDULER] {}: Update train {}", state.current_date.to_string(), current_task.index);
+      stats.add_tasks(type, 1, clock.elapsed_time());
+    }
 
-        if (update_train(state.network.trains[current_task.index], current_task.index)) {
-          need_cooldown = true;
-        }
+    stats.end_frame(state.scheduler.size());
 
-        continue;
-      }
+    if (m_wait_target) {
+      const Date target = *m_wait_target;
+      m_wait_target.reset();
+      fast_forward(target);
     }
 
     if (need_cooldown) {
@@ -141,6 +175,79 @@ namespace ffw {
     }
   }
 
+  void WorldModel::fast_forward(Date target)
+  {
+    FFW_LOG_DEBUG("[SCHEDULER] {}: Fast forward to {}", state.current_date.to_string(), target.to_string());
+
+    // the hero stays idle and there is no cooldown, nobody is watching
+
+    runtime.hero.action = {};
+    runtime.hero.moves.clear();
+    m_phase = Phase::Running;
+    m_cooldown = {};
+
+    SchedulerStats& stats = runtime.scheduler_stats;
+    stats.start_frame();
+
+    while (state.scheduler.top().date < target) {
+      update_date();
+      update_hero_chunk();
+
+      if (state.scheduler.is_hero_turn()) {
+        wake_trains();
+
+        const uint64_t remaining = target.as_seconds() - state.current_date.as_seconds();
+        update_current_task_in_queue(static_cast<uint16_t>(std::min<uint64_t>(remaining, HeroIdleTime)));
+        continue;
+      }
+
+      gf::Clock clock;
+
+      if (is_grazing_turn(state.scheduler.top())) {
+        update_grazing_cows();
+        stats.add_tasks(TaskType::Actor, m_grazing_cows.size(), clock.elapsed_time());
+        continue;
+      }
+
+      const TaskType type = state.scheduler.top().type;
+      update_task();
+      stats.add_tasks(type, 1, clock.elapsed_time());
+    }
+
+    stats.end_frame(state.scheduler.size());
+
+    // the next task may be after the target, nothing happens in between
+    assert(!(target < state.current_date));
+    state.current_date = target;
+    update_hero_chunk();
+  }
+
+  bool WorldModel::update_task()
+  {
+    const Task& current_task = state.scheduler.top();
+
+    switch (current_task.type) {
+      case TaskType::Actor:
+        assert(current_task.index < state.actors.size());
+        FFW_LOG_DEBUG("[SCHEDULER] {}: Update actor {}", state.current_date.to_string(), current_task.index);
+        return update_actor(state.actors[current_task.index], current_task.index);
+
+      case TaskType::Train:
+        assert(current_task.index < state.network.trains.size());
+        FFW_LOG_DEBUG("[SCHEDULER] {}: Update train {}", state.current_date.to_string(), current_task.index);
+        return update_train(state.network.trains[current_task.index], current_task.index);
+
+      case TaskType::Herd:
+        assert(current_task.index < state.population.herds.size());
+        FFW_LOG_DEBUG("[SCHEDULER] {}: Update herd {}", state.current_date.to_string(), current_task.index);
+        update_herd(state.population.herds[current_task.index], current_task.index);
+        return false;
+    }
+
+    assert(false);
+    return false;
+  }
+
 
   bool WorldModel::is_prairie(gf::Vec2I position) const
   {
@@ -160,12 +267,16 @@ namespace ffw {
     }
 
     assert(floor_map.reverse.valid(position));
-    const ReverseMapCell& cell = floor_map.reverse(position);
+    const ReverseMapCell cell = floor_map.reverse(position);
 
     if (!cell.empty()) {
       return false;
     }
 
+    if (floor == Floor::Ground && runtime.network.compute_train_at(state.network.trains, position, state.current_date) != NoIndex) {
+      return false;
+    }
+
     return true;
   }
 
@@ -180,16 +291,20 @@ namespace ffw {
     FloorMap& floor_map = runtime.map.from_floor(actor.floor);
 
     assert(floor_map.reverse.valid(actor.position));
-    ReverseMapCell& old_reverse_cell = floor_map.reverse(actor.position);
+    ReverseMapCell old_reverse_cell = floor_map.reverse(actor.position);
     assert(old_reverse_cell.actor_index < state.actors.size());
     assert(&actor == &state.actors[old_reverse_cell.actor_index]);
+    const uint32_t actor_index = old_reverse_cell.actor_index;
 
     assert(floor_map.reverse.valid(position));
-    ReverseMapCell& new_reverse_cell = floor_map.reverse(position);
-    assert(floor_map.reverse(position).actor_index == NoIndex);
+    ReverseMapCell new_reverse_cell = floor_map.reverse(position);
+    assert(new_reverse_cell.actor_index == NoIndex);
 
-    actor.position = position;
     std::swap(old_reverse_cell.actor_index, new_reverse_cell.actor_index);
+    floor_map.reverse.set(actor.position, old_reverse_cell);
+    floor_map.reverse.set(position, new_reverse_cell);
+    actor.position = position;
+    runtime.actors.positions[actor_index] = position;
   }
 
   bool WorldModel::move_human(ActorState& actor, gf::Vec2I position)
@@ -219,7 +334,7 @@ namespace ffw {
 
       ActorState& mount = state.actors[mount_index];
       move_actor(mount, position);
-      actor.position = position;
+      set_actor_position(actor, position);
 
       if (move_length == 2) {
         update_current_task_in_queue(DiagonalWalkTime); // TODO: change the time according to mount
@@ -233,18 +348,308 @@ namespace ffw {
 
   void WorldModel::update_date()
   {
-    state.current_date = state.scheduler.queue.top().date;
+    state.current_date = state.scheduler.top().date;
   }
 
   void WorldModel::update_current_task_in_queue(uint16_t seconds)
   {
-    Task task = state.scheduler.queue.top();
-    state.scheduler.queue.pop();
-    task.date.add_seconds(seconds);
+    FFW_LOG_DEBUG("\tNext turn: {}", Date{ state.scheduler.top().date.as_seconds() + seconds }.to_string());
+    runtime.scheduler_stats.add_delay(seconds);
+
+    state.scheduler.reschedule_top(seconds);
+  }
+
+  void WorldModel::update_hero_chunk()
+  {
+    const gf::Vec2I hero_chunk = to_dormancy_chunk(state.hero().position);
+
+    if (hero_chunk == m_hero_chunk) {
+      return;
+    }
+
+    m_hero_chunk = hero_chunk;
+
+    wake_dormant_actors();
+    expand_herds();
+    collapse_herds();
+  }
+
+  void WorldModel::wake_dormant_actors()
+  {
+    if (state.dormancy.count == 0) {
+      return;
+    }
+
+    for (int32_t j = -DormancyChunkDistance; j <= DormancyChunkDistance; ++j) {
+      for (int32_t i = -DormancyChunkDistance; i <= DormancyChunkDistance; ++i) {
+        for (const DormantActor& dormant : state.dormancy.wake(m_hero_chunk + gf::vec(i, j))) {
+          wake_actor(dormant);
+        }
+      }
+    }
+  }
+
+  void WorldModel::park_actor(ActorState& actor, uint32_t actor_index)
+  {
+    assert(state.scheduler.top().type == TaskType::Actor && state.scheduler.top().index == actor_index);
+    FFW_LOG_DEBUG("[SCHEDULER] {}: Park actor {}", state.current_date.to_string(), actor_index);
+    state.dormancy.park(actor.position, actor_index, state.current_date);
+    state.scheduler.pop();
+  }
+
+  void WorldModel::wake_actor(const DormantActor& dormant)
+  {
+    assert(dormant.index < state.actors.size());
+    assert(!(state.current_date < dormant.date));
+
+    const uint64_t elapsed = state.current_date.as_seconds() - dormant.date.as_seconds();
+    FFW_LOG_DEBUG("[SCHEDULER] {}: Wake actor {} after {}s", state.current_date.to_string(), dormant.index, elapsed);
+
+    catch_up_actor(state.actors[dormant.index], dormant.index, elapsed);
+
+    // spread the woken actors so that they do not all play at the same time
+
+    Date date = state.current_date;
+    date.add_seconds(static_cast<uint16_t>(1 + m_random->compute_uniform_integer(IdleTime)));
+    state.scheduler.push({ date, TaskType::Actor, dormant.index });
+  }
+
+  void WorldModel::expand_herds()
+  {
+    const gf::Vec2I hero_position = state.hero().position;
+
+    for (uint32_t index = 0; index < state.population.herds.size(); ++index) {
+      HerdState& herd = state.population.herds[index];
+
+      if (!herd.expanded() && gf::chebyshev_distance(herd.center, hero_position) <= herd_expansion_distance) {
+        expand_herd(herd, index);
+      }
+    }
+  }
+
+  void WorldModel::expand_herd(HerdState& herd, uint32_t herd_index)
+  {
+    assert(!herd.expanded());
+    FFW_LOG_DEBUG("[SCHEDULER] {}: Expand herd of {} at {},{}", state.current_date.to_string(), herd.count, herd.center.x, herd.center.y);
+
+    // the herd task is scheduled again when the herd is collapsed
+    state.scheduler.remove(TaskType::Herd, herd_index);
+
+    herd.first_actor = uint32_t(state.actors.size());
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < herd.count; ++i) {
+      std::optional<gf::Vec2I> position;
+
+      for (int tries = 0; tries < MaxHerdPlacementTries; ++tries) {
+        const gf::Vec2I candidate = herd.center + gf::vec(m_random->compute_uniform_integer(2 * HerdSpread + 1), m_random->compute_uniform_integer(2 * HerdSpread + 1)) - HerdSpread;
+
+        if (is_prairie(candidate) && is_walkable(Floor::Ground, candidate)) {
+          position = candidate;
+          break;
+        }
+      }
+
+      if (!position) {
+        continue;
+      }
+
+      const uint32_t index = uint32_t(state.actors.size());
+
+      ActorState actor = {};
+      actor.data = herd.data;
+      actor.position = *position;
+      actor.floor = Floor::Ground;
+      actor.feature = AnimalFeature{};
+      runtime.actors.push_back(actor);
+      state.actors.push_back(std::move(actor));
+
+      ReverseMapCell cell = runtime.map.ground.reverse(*position);
+      cell.actor_index = index;
+      runtime.map.ground.reverse.set(*position, cell);
+
+      Date date = state.current_date;
+      date.add_seconds(static_cast<uint16_t>(1 + m_random->compute_uniform_integer(GrazeTime)));
+      state.scheduler.push({ date, TaskType::Actor, index });
+
+      ++count;
+    }
+
+    herd.count = count;
+  }
+
+  void WorldModel::collapse_herds()
+  {
+    for (uint32_t index = 0; index < state.population.herds.size(); ++index) {
+      HerdState& herd = state.population.herds[index];
+
+      if (herd.expanded() && can_collapse_herd(herd)) {
+        collapse_herd(herd, index);
+      }
+    }
+  }
+
+  bool WorldModel::can_collapse_herd(const HerdState& herd) const
+  {
+    if (gf::chebyshev_distance(herd.center, state.hero().position) <= herd_expansion_distance) {
+      return false;
+    }
+
+    // all the members must be parked, so that they are not in the scheduler anymore
+
+    for (uint32_t index = herd.first_actor; index < herd.first_actor + herd.count; ++index) {
+      const ActorState& actor = state.actors[index];
+
+      if (actor.feature.from<ActorType::Animal>().mounted_by != NoIndex) {
+        return false;
+      }
+
+      if (!state.dormancy.contains(actor.position, index)) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  void WorldModel::collapse_herd(HerdState& herd, uint32_t herd_index)
+  {
+    assert(herd.expanded());
+    FFW_LOG_DEBUG("[SCHEDULER] {}: Collapse herd of {} at {},{}", state.current_date.to_string(), herd.count, herd.center.x, herd.center.y);
+
+    const uint32_t first_actor = herd.first_actor;
+    const uint32_t member_count = herd.count;
+
+    // the herd is where its members are
+
+    gf::Vec2I center = { 0, 0 };
+
+    for (uint32_t index = first_actor; index < first_actor + member_count; ++index) {
+      center += state.actors[index].position;
+    }
+
+    if (member_count > 0) {
+      herd.center = center / int32_t(member_count);
+    }
+
+    herd.count = std::max(herd.count, HerdMinSize);
+    herd.date = state.current_date;
+    herd.first_actor = NoIndex;
+
+    remove_actors(first_actor, member_count);
+
+    Date date = state.current_date;
+    date.add_seconds(HerdTime);
+    state.scheduler.push({ date, TaskType::Herd, herd_index });
+  }
+
+  void WorldModel::remove_actors(uint32_t first, uint32_t count)
+  {
+    assert(first > 0); // not the hero
+    assert(first + count <= state.actors.size());
+
+    // the actors are parked, they are only in the dormancy and the reverse map
+
+    for (uint32_t index = first; index < first + count; ++index) {
+      const ActorState& actor = state.actors[index];
+      state.dormancy.remove(actor.position, index);
+
+      FloorMap& floor_map = runtime.map.from_floor(actor.floor);
+      ReverseMapCell cell = floor_map.reverse(actor.position);
+      assert(cell.actor_index == index);
+      cell.actor_index = NoIndex;
+      floor_map.reverse.set(actor.position, cell);
+    }
+
+    // the next actors are moved, so every reference to them is updated
+
+    for (uint32_t index = first + count; index < state.actors.size(); ++index) {
+      const ActorState& actor = state.actors[index];
+      FloorMap& floor_map = runtime.map.from_floor(actor.floor);
+      ReverseMapCell cell = floor_map.reverse(actor.position);
+
+      if (cell.actor_index == index) {
+        cell.actor_index = index - count;
+        floor_map.reverse.set(actor.position, cell);
+      }
+    }
+
+    state.actors.erase(state.actors.begin() + first, state.actors.begin() + first + count);
+    runtime.actors.erase(first, count);
+
+    auto update_index = [first, count](uint32_t& index) {
+      assert(index == NoIndex || index < first || index >= first + count);
+
+      if (index != NoIndex && index >= first + count) {
+        index -= count;
+      }
+    };
+
+    for (ActorState& actor : state.actors) {
+      switch (actor.feature.type()) {
+        case ActorType::Human:
+          update_index(actor.feature.from<ActorType::Human>().mounting);
+          break;
+        case ActorType::Animal:
+          update_index(actor.feature.from<ActorType::Animal>().mounted_by);
+          break;
+        case ActorType::None:
+          break;
+      }
+    }
+
+    state.scheduler.update_indices([&](Task& task) {
+      if (task.type == TaskType::Actor) {
+        update_index(task.index);
+      }
+    });
+
+    state.dormancy.update_indices(update_index);
+
+    for (HerdState& herd : state.population.herds) {
+      update_index(herd.first_actor);
+    }
+  }
+
+  void WorldModel::update_herd(HerdState& herd, uint32_t herd_index)
+  {
+    if (herd.expanded()) {
+      // the members are now simulated individually
+      state.scheduler.pop();
+      return;
+    }
+
+    if (gf::chebyshev_distance(herd.center, state.hero().position) <= herd_expansion_distance) {
+      expand_herd(herd, herd_index); // removes the current task
+      return;
+    }
+
+    // the herd wanders around its home
 
-    gf::Log::debug("\tNext turn: {}", task.date.to_string());
+    const uint64_t elapsed = state.current_date.as_seconds() - herd.date.as_seconds();
+    const int32_t drift = static_cast<int32_t>(std::min<uint64_t>(elapsed / GrazeTime, HerdRoamingRadius));
+
+    for (int tries = 0; tries < MaxHerdPlacementTries && drift > 0; ++tries) {
+      const gf::Vec2I candidate = herd.center + gf::vec(m_random->compute_uniform_integer(2 * drift + 1), m_random->compute_uniform_integer(2 * drift + 1)) - drift;
+
+      if (gf::chebyshev_distance(candidate, herd.home) <= HerdRoamingRadius && is_prairie(candidate)) {
+        herd.center = candidate;
+        break;
+      }
+    }
 
-    state.scheduler.queue.push(task);
+    // births and deaths
+
+    if (m_random->compute_bernoulli(HerdChangeProbability)) {
+      if (m_random->compute_bernoulli(0.5)) {
+        herd.count = std::min(uint8_t(herd.count + 1), HerdMaxSize);
+      } else {
+        herd.count = std::max(uint8_t(herd.count - 1), HerdMinSize);
+      }
+    }
+
+    herd.date = state.current_date;
+    update_current_task_in_queue(HerdTime);
   }
 
   bool WorldModel::update_hero()
@@ -258,7 +663,7 @@ namespace ffw {
       return false;
     }
 
-    gf::Log::debug("[SCHEDULER] {}: Update hero", state.current_date.to_string());
+    FFW_LOG_DEBUG("[SCHEDULER] {}: Update hero", state.current_date.to_string());
     bool need_cooldown = false;
 
     switch (runtime.hero.action.type()) {
@@ -304,6 +709,10 @@ namespace ffw {
       case ActionType::Reload:
         need_cooldown = update_actor_reload(state.hero());
         break;
+
+      case ActionType::WaitTrain:
+        need_cooldown = update_hero_wait_train();
+        break;
     }
 
     if (check_actor_position(state.hero())) {
@@ -314,6 +723,53 @@ namespace ffw {
     return need_cooldown;
   }
 
+  bool WorldModel::update_hero_wait_train()
+  {
+    const ActorState& hero = state.hero();
+
+    if (hero.floor != Floor::Ground) {
+      return false;
+    }
+
+    const uint32_t station_index = runtime.network.compute_station_near(state.network.stations, hero.position);
+
+    if (station_index == NoIndex) {
+      state.add_message("There is no railway station around.");
+      return false;
+    }
+
+    const TrainStop stop = runtime.network.compute_next_departure(station_index, state.current_date);
+
+    if (!(state.current_date < stop.arrival)) {
+      state.add_message("The train is in the station.");
+      return false;
+    }
+
+    state.add_message(fmt::format("You wait for the train until <style=date>{}</>.", stop.arrival.to_string_hours_minutes()));
+
+    // the hero task stays at the top, fast_forward() takes it
+    m_wait_target = stop.arrival;
+    return true;
+  }
+
+  uint32_t WorldModel::compute_actor_index(const ActorState& actor) const
+  {
+    assert(state.actors.data() <= &actor && &actor < state.actors.data() + state.actors.size());
+    return static_cast<uint32_t>(&actor - state.actors.data());
+  }
+
+  void WorldModel::set_actor_position(ActorState& actor, gf::Vec2I position)
+  {
+    actor.position = position;
+    runtime.actors.positions[compute_actor_index(actor)] = position;
+  }
+
+  void WorldModel::set_actor_floor(ActorState& actor, Floor floor)
+  {
+    actor.floor = floor;
+    runtime.actors.floors[compute_actor_index(actor)] = floor;
+  }
+
   bool WorldModel::check_actor_position(ActorState& actor)
   {
     MapCellDecoration decoration = MapCellDecoration::None;
@@ -344,7 +800,7 @@ namespace ffw {
 
   bool WorldModel::change_floor(ActorState& actor, Floor new_floor)
   {
-    gf::Log::debug("Want to change floor: {} -> {}", int(actor.floor), int(new_floor));
+    FFW_LOG_DEBUG("Want to change floor: {} -> {}", int(actor.floor), int(new_floor));
 
     if (actor.floor == new_floor) {
       return false;
@@ -358,17 +814,19 @@ namespace ffw {
     FloorMap& old_floor_map = runtime.map.from_floor(actor.floor);
     FloorMap& new_floor_map = runtime.map.from_floor(new_floor);
 
-    ReverseMapCell& old_map_cell = old_floor_map.reverse(actor.position);
-    ReverseMapCell& new_map_cell = new_floor_map.reverse(actor.position);
+    ReverseMapCell old_map_cell = old_floor_map.reverse(actor.position);
+    ReverseMapCell new_map_cell = new_floor_map.reverse(actor.position);
 
     if (new_map_cell.actor_index != NoIndex) {
       return false;
     }
 
-    gf::Log::debug("Change floor!");
+    FFW_LOG_DEBUG("Change floor!");
 
     std::swap(old_map_cell.actor_index, new_map_cell.actor_index);
-    actor.floor = new_floor;
+    old_floor_map.reverse.set(actor.position, old_map_cell);
+    new_floor_map.reverse.set(actor.position, new_map_cell);
+    set_actor_floor(actor, new_floor);
 
     // update fov for hero
 
@@ -386,26 +844,25 @@ namespace ffw {
     FloorMap& floor_map = runtime.map.from_floor(actor.floor);
 
     HumanFeature& actor_feature = actor.feature.from<ActorType::Human>();
-    ReverseMapCell& actor_cell = floor_map.reverse(actor.position);
 
     if (actor_feature.mounting != NoIndex) {
       // the hero is already mouting an animal
       return false;
     }
 
-    gf::Log::debug("The hero is not mouting an animal.");
+    FFW_LOG_DEBUG("The hero is not mouting an animal.");
 
     std::vector<uint32_t> actor_indices;
 
-    for (const gf::Vec2I neighbor : floor_map.reverse.compute_4_neighbors_range(actor.position)) {
-      const ReverseMapCell& cell = floor_map.reverse(neighbor);
+    for (const gf::Vec2I neighbor : floor_map.background.compute_4_neighbors_range(actor.position)) {
+      const ReverseMapCell cell = floor_map.reverse(neighbor);
 
       if (cell.actor_index == NoIndex) {
         // not actor on this cell
         continue;
       }
 
-      gf::Log::debug("There is an actor next to the hero: {}", cell.actor_index);
+      FFW_LOG_DEBUG("There is an actor next to the hero: {}", cell.actor_index);
 
       actor_indices.push_back(cell.actor_index);
     }
@@ -419,7 +876,7 @@ namespace ffw {
         continue;
       }
 
-      gf::Log::debug("The actor {} is an animal", animal_actor_index);
+      FFW_LOG_DEBUG("The actor {} is an animal", animal_actor_index);
 
       const AnimalDataFeature& animal_data_feature = animal_actor.data->feature.from<ActorType::Animal>();
 
@@ -428,7 +885,7 @@ namespace ffw {
         continue;
       }
 
-      gf::Log::debug("The actor {} can be mounted", animal_actor_index);
+      FFW_LOG_DEBUG("The actor {} can be mounted", animal_actor_index);
 
       AnimalFeature& animal_feature = animal_actor.feature.from<ActorType::Animal>();
 
@@ -437,12 +894,15 @@ namespace ffw {
         continue;
       }
 
-      gf::Log::debug("Mount!");
+      FFW_LOG_DEBUG("Mount!");
+
+      ReverseMapCell actor_cell = floor_map.reverse(actor.position);
+      std::swap(animal_feature.mounted_by, actor_cell.actor_index);
+      floor_map.reverse.set(actor.position, actor_cell);
 
       actor_feature.mounting = animal_actor_index;
-      actor.position = animal_actor.position;
+      set_actor_position(actor, animal_actor.position);
 
-      std::swap(animal_feature.mounted_by, actor_cell.actor_index);
       update_current_task_in_queue(MountTime);
       break;
     }
@@ -461,30 +921,31 @@ namespace ffw {
       return false;
     }
 
-    gf::Log::debug("The actor is mouting an animal.");
+    FFW_LOG_DEBUG("The actor is mouting an animal.");
 
     std::optional<gf::Vec2I> position;
 
-    for (const gf::Vec2I neighbor : floor_map.reverse.compute_4_neighbors_range(actor.position)) {
+    for (const gf::Vec2I neighbor : floor_map.background.compute_4_neighbors_range(actor.position)) {
       if (!is_walkable(actor.floor, neighbor)) {
         continue;
       }
 
-      gf::Log::debug("There is an empty place next to the actor");
+      FFW_LOG_DEBUG("There is an empty place next to the actor");
 
       position = neighbor;
       break;
     }
 
     if (!position) {
-      gf::Log::debug("There is no empty place next to the actor");
+      FFW_LOG_DEBUG("There is no empty place next to the actor");
       return false;
     }
 
-    actor.position = *position;
-    ReverseMapCell& actor_cell = floor_map.reverse(actor.position);
+    set_actor_position(actor, *position);
+    ReverseMapCell actor_cell = floor_map.reverse(actor.position);
     assert(actor_cell.actor_index == NoIndex);
     actor_cell.actor_index = 0;
+    floor_map.reverse.set(actor.position, actor_cell);
 
     ActorState& mount = state.actors[actor_feature.mounting];
     assert(mount.feature.type() == ActorType::Animal);
@@ -497,19 +958,21 @@ namespace ffw {
 
   bool WorldModel::update_actor_reload(ActorState& actor)
   {
-    if (actor.weapon.data && actor.weapon.data->feature.type() == ItemType::Firearm && actor.ammunition.data && actor.ammunition.data->feature.type() == ItemType::Ammunition) {
-      const FirearmDataFeature& firearm = actor.weapon.data->feature.from<ItemType::Firearm>();
-      const AmmunitionDataFeature& ammunition = actor.ammunition.data->feature.from<ItemType::Ammunition>();
+    HumanState& human = state.human(actor);
+
+    if (human.weapon.data && human.weapon.data->feature.type() == ItemType::Firearm && human.ammunition.data && human.ammunition.data->feature.type() == ItemType::Ammunition) {
+      const FirearmDataFeature& firearm = human.weapon.data->feature.from<ItemType::Firearm>();
+      const AmmunitionDataFeature& ammunition = human.ammunition.data->feature.from<ItemType::Ammunition>();
 
       if (firearm.caliber == ammunition.caliber) {
-        const int8_t needed_cartridges = firearm.capacity - actor.weapon.cartridges;
-        const int8_t loaded_cartriges = static_cast<int8_t>(std::min<int16_t>(needed_cartridges, actor.ammunition.count));
+        const int8_t needed_cartridges = firearm.capacity - human.weapon.cartridges;
+        const int8_t loaded_cartriges = static_cast<int8_t>(std::min<int16_t>(needed_cartridges, human.ammunition.count));
 
         if (loaded_cartriges > 0) {
-          actor.weapon.cartridges += loaded_cartriges;
-          actor.ammunition.count -= loaded_cartriges;
+          human.weapon.cartridges += loaded_cartriges;
+          human.ammunition.count -= loaded_cartriges;
 
-          state.add_message(fmt::format("<style=character>{}</> reloads its weapon with {} cartridges.", actor.feature.from<ActorType::Human>().name, loaded_cartriges));
+          state.add_message(fmt::format("<style=character>{}</> reloads its weapon with {} cartridges.", human.name, loaded_cartriges));
 
           update_current_task_in_queue(firearm.reload_time);
           return true;
@@ -521,9 +984,17 @@ namespace ffw {
     return false;
   }
 
-  bool WorldModel::update_actor(ActorState& actor)
+  bool WorldModel::update_actor(ActorState& actor, uint32_t actor_index)
   {
-    const int32_t distance_to_hero = gf::chebyshev_distance(actor.position, state.hero().position);
+    const gf::Vec2I position = runtime.actors.positions[actor_index];
+    assert(position == actor.position);
+
+    if (gf::chebyshev_distance(to_dormancy_chunk(position), m_hero_chunk) > DormancyChunkDistance) {
+      park_actor(actor, actor_index);
+      return false; // do not cooldown in this case
+    }
+
+    const int32_t distance_to_hero = gf::chebyshev_distance(position, runtime.actors.positions.front());
 
     if (distance_to_hero > IdleDistance) {
       update_current_task_in_queue(static_cast<uint16_t>(distance_to_hero - IdleDistance + IdleTime));
@@ -548,59 +1019,169 @@ namespace ffw {
 
   void WorldModel::update_cow(ActorState& cow)
   {
+    // grazing cows are updated in batch, see update_grazing_cows()
     assert(cow.feature.type() == ActorType::Animal);
+    assert(cow.feature.from<ActorType::Animal>().mounted_by != NoIndex);
+    update_current_task_in_queue(IdleTime);
+  }
 
-    if (cow.feature.from<ActorType::Animal>().mounted_by != NoIndex) {
-      update_current_task_in_queue(IdleTime);
-      return;
+  bool WorldModel::is_grazing_turn(const Task& task) const
+  {
+    using namespace gf::literals;
+
+    if (task.type != TaskType::Actor) {
+      return false;
     }
 
-    gf::Orientation orientation = random_orientation(m_random);
-    gf::Vec2I new_position = cow.position + gf::displacement(orientation);
+    assert(task.index < state.actors.size());
+
+    if (runtime.actors.types[task.index] != ActorType::Animal) {
+      return false;
+    }
+
+    // same conditions as in update_actor()
+    const gf::Vec2I position = runtime.actors.positions[task.index];
+
+    if (gf::chebyshev_distance(to_dormancy_chunk(position), m_hero_chunk) > DormancyChunkDistance || gf::chebyshev_distance(position, runtime.actors.positions.front()) > IdleDistance) {
+      return false;
+    }
+
+    const ActorState& actor = state.actors[task.index];
+    return actor.data->label.id == "Cow"_id && actor.feature.from<ActorType::Animal>().mounted_by == NoIndex;
+  }
+
+  void WorldModel::update_grazing_cows()
+  {
+    // all the grazing cows of the current date, even if other tasks are between them
+
+    m_grazing_cows.clear();
+    m_grazing_tasks.clear();
+
+    state.scheduler.pop_current_if([this](const Task& task) { return is_grazing_turn(task); }, m_grazing_tasks);
+
+    for (const Task& task : m_grazing_tasks) {
+      m_grazing_cows.push_back(task.index);
+    }
+
+    std::sort(m_grazing_cows.begin(), m_grazing_cows.end());
+    FFW_LOG_DEBUG("[SCHEDULER] {}: Update {} grazing cows", state.current_date.to_string(), m_grazing_cows.size());
+
+    // the moves are decided in parallel, the map is not modified during this phase
+
+    m_grazing_moves.resize(m_grazing_cows.size());
+
+    parallel_for(m_grazing_cows.size(), [this](std::size_t i) {
+      const uint32_t index = m_grazing_cows[i];
+      SplitMix64 generator(compute_task_seed(state.current_date.as_seconds(), index));
+      m_grazing_moves[i] = compute_cow_move(index, generator);
+    }, GrazingMinCountPerThread);
+
+    // the moves are applied in index order, if two cows want the same cell, the first one gets it
+
+    m_grazing_tasks.clear();
+
+    for (std::size_t i = 0; i < m_grazing_cows.size(); ++i) {
+      const uint32_t index = m_grazing_cows[i];
+      const gf::Vec2I new_position = m_grazing_moves[i];
+
+      if (new_position != runtime.actors.positions[index] && is_walkable(runtime.actors.floors[index], new_position)) {
+        move_actor(state.actors[index], new_position);
+      }
+
+      Date date = state.current_date;
+      date.add_seconds(GrazeTime);
+      m_grazing_tasks.push_back({ date, TaskType::Actor, index });
+      runtime.scheduler_stats.add_delay(GrazeTime);
+    }
+
+    state.scheduler.schedule_many(m_grazing_tasks);
+  }
+
+  gf::Vec2I WorldModel::compute_cow_move(uint32_t cow_index, SplitMix64& generator) const
+  {
+    const gf::Vec2I position = runtime.actors.positions[cow_index];
+    const Floor floor = runtime.actors.floors[cow_index];
+
+    gf::Orientation orientation = random_orientation(generator);
+    gf::Vec2I new_position = position + gf::displacement(orientation);
 
     int tries = 0;
 
     for (;;) {
       if (tries == MaxMoveTries) {
-        new_position = cow.position;
+        new_position = position;
         break;
       }
 
-      if (is_walkable(cow.floor, new_position) && is_prairie(new_position)) { // TODO: maybe change this, a cow should be able to walk anywhere
+      if (is_walkable(floor, new_position) && is_prairie(new_position)) { // TODO: maybe change this, a cow should be able to walk anywhere
         break;
       }
 
-      orientation = random_orientation(m_random);
-      new_position = cow.position + gf::displacement(orientation);
+      orientation = random_orientation(generator);
+      new_position = position + gf::displacement(orientation);
       ++tries;
     }
 
-    move_actor(cow, new_position);
-    update_current_task_in_queue(GrazeTime);
+    return new_position;
   }
 
-  bool WorldModel::update_train(TrainState& train, uint32_t train_index)
+  void WorldModel::catch_up_actor(ActorState& actor, uint32_t actor_index, uint64_t elapsed)
   {
-    runtime.set_reverse_train(train, NoIndex);
+    using namespace gf::literals;
 
+    switch (actor.data->label.id) {
+      case "Cow"_id:
+        catch_up_cow(actor, actor_index, elapsed);
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  void WorldModel::catch_up_cow(ActorState& cow, uint32_t cow_index, uint64_t elapsed)
+  {
+    assert(cow.feature.type() == ActorType::Animal);
+
+    if (cow.feature.from<ActorType::Animal>().mounted_by != NoIndex) {
+      return;
+    }
+
+    // a few moves are enough to make the cow look like it was grazing while the hero was away
+
+    const uint64_t moves = std::min(elapsed / GrazeTime, MaxCatchUpMoves);
+    SplitMix64 generator(compute_task_seed(state.current_date.as_seconds(), cow_index));
+
+    for (uint64_t i = 0; i < moves; ++i) {
+      move_actor(cow, compute_cow_move(cow_index, generator));
+    }
+  }
+
+  bool WorldModel::update_train(TrainState& train, uint32_t train_index)
+  {
     const uint32_t new_index = runtime.network.prev_position(train.railway_index);
     assert(new_index < runtime.network.railway.size());
     const gf::Vec2I new_position = runtime.network.railway[new_index];
 
     train.railway_index = new_index;
+    train.reference = state.current_date;
+
+    const int32_t distance_to_hero = gf::chebyshev_distance(new_position, state.hero().position);
 
-    runtime.set_reverse_train(train, train_index);
+    if (distance_to_hero > TrainSleepDistance) {
+      FFW_LOG_DEBUG("[SCHEDULER] {}: Train {} goes to sleep", state.current_date.to_string(), train_index);
+      train.awake = false;
+      state.scheduler.pop();
+      return false;
+    }
 
-    if (auto iterator = std::find_if(state.network.stations.begin(), state.network.stations.end(), [new_index](const StationState& station) {
-      return station.index == new_index;
-    }); iterator != state.network.stations.end()) {
-      update_current_task_in_queue(iterator->stop_time);
+    if (const uint32_t station_index = runtime.network.station_at(new_index); station_index != NoIndex) {
+      assert(station_index < state.network.stations.size());
+      update_current_task_in_queue(state.network.stations[station_index].stop_time);
     } else {
       update_current_task_in_queue(TrainTime);
     }
 
-    const int32_t distance_to_hero = gf::chebyshev_distance(new_position, state.hero().position);
-
     if (distance_to_hero > IdleDistance) {
       return false; // do not cooldown
     }
@@ -608,4 +1189,32 @@ namespace ffw {
     return true;
   }
 
+  void WorldModel::wake_trains()
+  {
+    const gf::Vec2I hero_position = state.hero().position;
+
+    for (uint32_t train_index = 0; train_index < state.network.trains.size(); ++train_index) {
+      TrainState& train = state.network.trains[train_index];
+
+      if (train.awake) {
+        continue;
+      }
+
+      const TrainPosition position = runtime.network.compute_train_position(train, state.current_date);
+      assert(position.railway_index < runtime.network.railway.size());
+
+      if (gf::chebyshev_distance(runtime.network.railway[position.railway_index], hero_position) > TrainWakeDistance) {
+        continue;
+      }
+
+      FFW_LOG_DEBUG("[SCHEDULER] {}: Train {} wakes up", state.current_date.to_string(), train_index);
+
+      train.railway_index = position.railway_index;
+      train.reference = position.arrival;
+      train.awake = true;
+
+      state.scheduler.push({ position.departure, TaskType::Train, train_index });
+    }
+  }
+
 }
@@ -2,11 +2,14 @@
 #define FFW_WORLD_MODEL_H
 
 #include <atomic>
+#include <optional>
+#include <vector>
 
 #include <gf2/core/Model.h>
 #include <gf2/core/Random.h>
 
 #include "ActorState.h"
+#include "Parallel.h"
 #include "WorldData.h"
 #include "WorldGenerationStep.h"
 #include "WorldRuntime.h"
@@ -14,6 +17,8 @@
 
 namespace ffw {
 
+  inline constexpr int32_t DefaultHerdExpansionDistance = 96;
+
   struct WorldModel : gf::Model {
     WorldModel(gf::Random* random);
 
@@ -21,10 +26,15 @@ namespace ffw {
     WorldState state;
     WorldRuntime runtime;
 
+    int32_t herd_expansion_distance = DefaultHerdExpansionDistance;
+
     void bind(std::atomic<WorldGenerationStep>& step);
 
     void update(gf::Time time) override;
 
+    // run the simulation without the render loop until the target date
+    void fast_forward(Date target);
+
     bool is_prairie(gf::Vec2I position) const;
 
     bool is_walkable(Floor floor, gf::Vec2I position) const;
@@ -42,10 +52,38 @@ namespace ffw {
     Phase m_phase = Phase::Running;
     gf::Time m_cooldown;
 
+    gf::Vec2I m_hero_chunk = { -1, -1 };
+
+    std::optional<Date> m_wait_target; // fast forward at the end of the frame
+
+    std::vector<uint32_t> m_grazing_cows;
+    std::vector<gf::Vec2I> m_grazing_moves;
+    std::vector<Task> m_grazing_tasks;
+
     void update_date();
+    bool update_task();
     void update_current_task_in_queue(uint16_t seconds);
 
+    void update_hero_chunk();
+
+    void wake_dormant_actors();
+    void park_actor(ActorState& actor, uint32_t actor_index);
+    void wake_actor(const DormantActor& dormant);
+
+    void expand_herds();
+    void expand_herd(HerdState& herd, uint32_t herd_index);
+    void collapse_herds();
+    bool can_collapse_herd(const HerdState& herd) const;
+    void collapse_herd(HerdState& herd, uint32_t herd_index);
+    void remove_actors(uint32_t first, uint32_t count);
+    void update_herd(HerdState& herd, uint32_t herd_index);
+
     bool update_hero();
+    bool update_hero_wait_train();
+
+    uint32_t compute_actor_index(const ActorState& actor) const;
+    void set_actor_position(ActorState& actor, gf::Vec2I position);
+    void set_actor_floor(ActorState& actor, Floor floor);
 
     bool check_actor_position(ActorState& actor);
     bool change_floor(ActorState& actor, Floor new_floor);
@@ -54,11 +92,18 @@ namespace ffw {
     bool update_actor_dismount(ActorState& actor);
     bool update_actor_reload(ActorState& actor);
 
-    bool update_actor(ActorState& actor);
+    bool update_actor(ActorState& actor, uint32_t actor_index);
     void update_cow(ActorState& cow);
+    bool is_grazing_turn(const Task& task) const;
+    void update_grazing_cows();
+    gf::Vec2I compute_cow_move(uint32_t cow_index, SplitMix64& generator) const;
+
+    void catch_up_actor(ActorState& actor, uint32_t actor_index, uint64_t elapsed);
+    void catch_up_cow(ActorState& cow, uint32_t cow_index, uint64_t elapsed);
 
 
     bool update_train(TrainState& train, uint32_t train_index);
+    void wake_trains();
 
   };
 
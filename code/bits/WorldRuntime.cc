@@ -4,29 +4,33 @@
 
 #include <algorithm>
 #include <numeric>
+#include <utility>
 
+#include "Index.h"
 #include "MapRuntime.h"
 #include "NetworkState.h"
 #include "Settings.h"
+#include "Times.h"
 #include "WorldState.h"
 
 namespace ffw {
 
-  void WorldRuntime::sort_actors_by_distance(const std::vector<ActorState>& actors)
+  void WorldRuntime::sort_actors_by_distance()
   {
-    assert(!actors.empty());
+    const std::vector<gf::Vec2I>& positions = actors.positions;
+    assert(!positions.empty());
 
-    if (actors_by_distance.size() != actors.size()) {
-      actors_by_distance.resize(actors.size());
+    if (actors_by_distance.size() != positions.size()) {
+      actors_by_distance.resize(positions.size());
       std::iota(actors_by_distance.begin(), actors_by_distance.end(), 0);
     }
 
-    const ActorState& hero_actor = actors.front();
+    const gf::Vec2I hero_position = positions.front();
 
     std::sort(actors_by_distance.begin(), actors_by_distance.end(), [&](std::size_t lhs, std::size_t rhs) {
-      assert(lhs < actors.size());
-      assert(rhs < actors.size());
-      return gf::manhattan_distance(actors[lhs].position, hero_actor.position) < gf::manhattan_distance(actors[rhs].position, hero_actor.position);
+      assert(lhs < positions.size());
+      assert(rhs < positions.size());
+      return gf::manhattan_distance(positions[lhs], hero_position) < gf::manhattan_distance(positions[rhs], hero_position);
     });
   }
 
@@ -35,27 +39,6 @@ namespace ffw {
     return gf::RectI::from_center_size(view_center, GameBoxSize);
   }
 
-  void WorldRuntime::set_reverse_train(const TrainState& train, uint32_t train_index)
-  {
-    uint32_t offset = 0;
-
-    for (std::size_t k = 0; k < TrainLength; ++k) {
-      const uint32_t railway_index = network.next_position(train.railway_index, offset);
-      assert(railway_index < network.railway.size());
-      const gf::Vec2I position = network.railway[railway_index];
-
-      for (int32_t i = -1; i <= 1; ++i) {
-        for (int32_t j = -1; j <= 1; ++j) {
-          const gf::Vec2I neighbor = { i, j };
-          const gf::Vec2I neighbor_position = position + neighbor;
-          map.ground.reverse(neighbor_position).train_index = train_index;
-        }
-      }
-
-      offset += 3;
-    }
-  }
-
   void WorldRuntime::bind([[maybe_unused]] const WorldData& data, const WorldState& state, gf::Random* random, std::atomic<WorldGenerationStep>& step)
   {
     view_center = state.hero().position;
@@ -63,8 +46,9 @@ namespace ffw {
 
     step.store(WorldGenerationStep::Network);
     bind_network(state);
-    bind_train(state);
-    sort_actors_by_distance(state.actors);
+    bind_timetable(state);
+    actors.bind(state);
+    sort_actors_by_distance();
   }
 
   void WorldRuntime::bind_network(const WorldState& state) {
@@ -84,12 +68,83 @@ namespace ffw {
     }
 
     assert(gf::manhattan_distance(network.railway.back(), network.railway.front()) == 1);
+
+    network.stations.resize(network.railway.size(), NoIndex);
+
+    for (const auto& [ station_index, station ] : gf::enumerate(state.network.stations)) {
+      assert(station.index < network.stations.size());
+      network.stations[station.index] = uint32_t(station_index);
+    }
+
+    // the delays are the same as in WorldModel::update_train
+
+    const uint32_t railway_size = uint32_t(network.railway.size());
+    network.arrivals.reserve(railway_size + 1);
+    uint64_t offset = 0;
+
+    for (uint32_t step = 0; step < railway_size; ++step) {
+      network.arrivals.push_back(offset);
+      const uint32_t station_index = network.stations[network.compute_step(step)];
+      offset += station_index == NoIndex ? TrainTime : state.network.stations[station_index].stop_time;
+    }
+
+    network.arrivals.push_back(offset);
+
+    // the cells next to the railway, with all the railway indices next to them
+
+    network.corridor = PositionMap<RailwayCell>(WorldSize);
+
+    for (uint32_t railway_index = 0; railway_index < railway_size; ++railway_index) {
+      for (int32_t i = -1; i <= 1; ++i) {
+        for (int32_t j = -1; j <= 1; ++j) {
+          const gf::Vec2I neighbor = { i, j };
+          const gf::Vec2I neighbor_position = network.railway[railway_index] + neighbor;
+
+          if (!network.corridor.valid(neighbor_position)) {
+            continue;
+          }
+
+          RailwayCell cell = network.corridor(neighbor_position);
+          cell.add(railway_index);
+          network.corridor.set(neighbor_position, cell);
+        }
+      }
+    }
   }
 
-  void WorldRuntime::bind_train(const WorldState& state)
+  void WorldRuntime::bind_timetable(const WorldState& state)
   {
-    for (const auto& [ train_index, train ] : gf::enumerate(state.network.trains)) {
-      set_reverse_train(train, uint32_t(train_index));
+    const uint64_t period = network.period();
+
+    network.timetables.resize(state.network.stations.size());
+    std::vector<uint32_t> stations_in_order(state.network.stations.size());
+
+    for (const auto& [ station_index, station ] : gf::enumerate(state.network.stations)) {
+      network.timetables[station_index].step = network.compute_step(station.index);
+      stations_in_order[station_index] = uint32_t(station_index);
+    }
+
+    // the trains all follow the same loop with a different origin
+
+    for (const TrainState& train : state.network.trains) {
+      const uint64_t train_arrival = network.arrivals[network.compute_step(train.railway_index)] % period;
+      const uint64_t origin = (train.reference.as_seconds() % period + period - train_arrival) % period;
+
+      for (StationTimetable& timetable : network.timetables) {
+        timetable.arrivals.push_back((origin + network.arrivals[timetable.step]) % period);
+      }
+    }
+
+    for (StationTimetable& timetable : network.timetables) {
+      std::sort(timetable.arrivals.begin(), timetable.arrivals.end());
+    }
+
+    std::sort(stations_in_order.begin(), stations_in_order.end(), [&](uint32_t lhs, uint32_t rhs) {
+      return network.timetables[lhs].step < network.timetables[rhs].step;
+    });
+
+    for (std::size_t i = 0; i < stations_in_order.size(); ++i) {
+      network.timetables[stations_in_order[i]].next_station = stations_in_order[(i + 1) % stations_in_order.size()];
     }
   }
 
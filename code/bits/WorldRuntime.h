@@ -6,35 +6,35 @@
 
 #include <gf2/core/Random.h>
 
+#include "ActorRuntime.h"
 #include "HeroRuntime.h"
 #include "MapRuntime.h"
 #include "NetworkRuntime.h"
+#include "SchedulerStats.h"
 #include "WorldGenerationStep.h"
 
 namespace ffw {
-  struct ActorState;
-  struct TrainState;
   struct WorldData;
   struct WorldState;
 
   struct WorldRuntime {
     gf::Vec2I view_center;
+    ActorRuntime actors;
     HeroRuntime hero;
     MapRuntime map;
     NetworkRuntime network;
+    SchedulerStats scheduler_stats;
 
     std::vector<std::size_t> actors_by_distance;
 
-    void sort_actors_by_distance(const std::vector<ActorState>& actors);
+    void sort_actors_by_distance();
 
     gf::RectI compute_view() const;
 
-    void set_reverse_train(const TrainState& train, uint32_t train_index);
-
     void bind(const WorldData& data, const WorldState& state, gf::Random* random, std::atomic<WorldGenerationStep>& step);
 
     void bind_network(const WorldState& state);
-    void bind_train(const WorldState& state);
+    void bind_timetable(const WorldState& state);
   };
 
 }
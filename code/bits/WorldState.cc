@@ -37,23 +37,29 @@ namespace ffw {
   {
     for (ActorState& actor : actors) {
       actor.data.bind_from(data.actors);
+    }
 
-      for (InventoryItemState& item : actor.inventory.items) {
+    for (HumanState& human : humans) {
+      for (InventoryItemState& item : human.inventory.items) {
         item.data.bind_from(data.items);
       }
 
-      if (actor.weapon.data) {
-        actor.weapon.data.bind_from(data.items);
+      if (human.weapon.data) {
+        human.weapon.data.bind_from(data.items);
       }
 
-      if (actor.ammunition.data) {
-        actor.ammunition.data.bind_from(data.items);
+      if (human.ammunition.data) {
+        human.ammunition.data.bind_from(data.items);
       }
     }
 
     for (ItemState& item : items) {
       item.data.bind_from(data.items);
     }
+
+    for (HerdState& herd : population.herds) {
+      herd.data.bind_from(data.actors);
+    }
   }
 
 
@@ -11,29 +11,35 @@
 #include "ActorState.h"
 #include "Date.h"
 #include "DebtState.h"
+#include "DormancyState.h"
 #include "ItemState.h"
 #include "MapState.h"
 #include "MessageLogState.h"
 #include "NetworkState.h"
+#include "PopulationState.h"
 #include "SchedulerState.h"
 
 namespace ffw {
   struct WorldData;
 
-  constexpr std::uint16_t StateVersion = 1;
+  constexpr std::uint16_t StateVersion = 8;
 
   struct WorldState {
+    uint64_t seed = 0; // the seed of the world generation
     Date current_date;
 
     MapState map;
     NetworkState network;
 
     std::vector<ActorState> actors;
+    std::vector<HumanState> humans;
     std::vector<ItemState> items;
+    PopulationState population;
 
     DebtState debt;
 
     SchedulerState scheduler;
+    DormancyState dormancy;
     MessageLogState log;
 
     ActorState& hero() {
@@ -46,6 +52,20 @@ namespace ffw {
       return actors.front();
     }
 
+    HumanState& human(const ActorState& actor) {
+      assert(actor.feature.type() == ActorType::Human);
+      const uint32_t index = actor.feature.from<ActorType::Human>().human;
+      assert(index < humans.size());
+      return humans[index];
+    }
+
+    const HumanState& human(const ActorState& actor) const {
+      assert(actor.feature.type() == ActorType::Human);
+      const uint32_t index = actor.feature.from<ActorType::Human>().human;
+      assert(index < humans.size());
+      return humans[index];
+    }
+
     void add_message(std::string message);
 
     void load_from_file(const std::filesystem::path& filename);
@@ -57,7 +77,7 @@ namespace ffw {
   template<typename Archive>
   Archive& operator|(Archive& ar, gf::MaybeConst<WorldState, Archive>& state)
   {
-    return ar | state.current_date | state.map | state.network | state.actors | state.debt | state.scheduler | state.log;
+    return ar | state.seed | state.current_date | state.map | state.network | state.actors | state.humans | state.population | state.debt | state.scheduler | state.dormancy | state.log;
   }
 
 }
@@ -1,9 +1,18 @@
+#include <string_view>
+
 #include "bits/FarFarWestSystem.h"
+#include "bits/Logging.h"
 
 #include "config.h"
 
-int main()
+int main(int argc, char* argv[])
 {
+  for (int i = 1; i < argc; ++i) {
+    if (std::string_view(argv[i]) == "--debug-log") {
+      ffw::set_debug_log_enabled(true);
+    }
+  }
+
   ffw::FarFarWestSystem game(ffw::FarFarWestDataDirectory);
   return game.run();
 }
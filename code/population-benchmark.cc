@@ -0,0 +1,132 @@
+#include <cstdint>
+#include <cstdlib>
+
+#include <atomic>
+#include <filesystem>
+#include <optional>
+#include <utility>
+
+#include <gf2/core/Clock.h>
+#include <gf2/core/Log.h>
+#include <gf2/core/Random.h>
+
+#include "bits/WorldGeneration.h"
+#include "bits/WorldGenerationStep.h"
+#include "bits/WorldModel.h"
+
+#include "config.h"
+
+/*
+ * Benchmark of the herd expansion distance: the hero walks from farm to
+ * farm for a simulated day and the herds expand when the hero comes close.
+ * Then the hero waits and the simulation is fast forwarded.
+ *
+ * Usage: population-benchmark [expansion distance] [simulated hours] [fast forwarded hours]
+ */
+
+namespace {
+
+  constexpr uint64_t SecondsInHour = 60 * 60;
+  constexpr uint64_t DefaultSimulatedHours = 24;
+  constexpr uint64_t DefaultFastForwardedHours = 24;
+  constexpr int MaxStuckTurns = 3;
+
+  gf::Vec2I random_orientation(gf::Random* random)
+  {
+    return { random->compute_uniform_integer(3) - 1, random->compute_uniform_integer(3) - 1 };
+  }
+
+  std::size_t next_farm(const ffw::MapState& map, std::size_t current)
+  {
+    for (std::size_t i = 1; i <= map.localities.size(); ++i) {
+      const std::size_t index = (current + i) % map.localities.size();
+
+      if (map.localities[index].type == ffw::LocalityType::Farm) {
+        return index;
+      }
+    }
+
+    return current;
+  }
+
+}
+
+int main(int argc, char* argv[])
+{
+  const int32_t expansion_distance = argc > 1 ? std::atoi(argv[1]) : ffw::DefaultHerdExpansionDistance;
+  const uint64_t simulated_hours = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : DefaultSimulatedHours;
+  const uint64_t fast_forwarded_hours = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : DefaultFastForwardedHours;
+
+  gf::Random random;
+  std::atomic<ffw::WorldGenerationStep> step(ffw::WorldGenerationStep::Start);
+
+  ffw::WorldModel model(&random);
+  model.herd_expansion_distance = expansion_distance;
+  model.data.load_from_file(std::filesystem::path(ffw::FarFarWestDataDirectory) / "data.json");
+  std::optional<ffw::WorldState> state = ffw::generate_world(ffw::generate_world_seed(&random), step);
+
+  if (!state) {
+    return EXIT_FAILURE;
+  }
+
+  model.state = std::move(*state);
+  model.bind(step);
+
+  ffw::Date target = model.state.current_date;
+  target.timestamp += simulated_hours * SecondsInHour;
+
+  std::size_t farm = next_farm(model.state.map, 0);
+  gf::Vec2I last_position = model.state.hero().position;
+  int stuck_turns = 0;
+  uint64_t hero_turns = 0;
+
+  gf::Clock clock;
+
+  while (model.state.current_date < target) {
+    if (model.state.scheduler.is_hero_turn()) {
+      const gf::Vec2I position = model.state.hero().position;
+      const gf::Vec2I goal = model.state.map.localities[farm].position;
+
+      stuck_turns = position == last_position ? stuck_turns + 1 : 0;
+      last_position = position;
+
+      if (gf::chebyshev_distance(position, goal) <= ffw::LocalityRadius || stuck_turns >= MaxStuckTurns) {
+        farm = next_farm(model.state.map, farm);
+        stuck_turns = 0;
+        model.runtime.hero.idle();
+      } else if (stuck_turns > 0) {
+        model.runtime.hero.move(random_orientation(&random));
+      } else {
+        model.runtime.hero.move(gf::sign(goal - position));
+      }
+
+      ++hero_turns;
+    }
+
+    model.update(gf::milliseconds(100)); // always longer than the cooldown
+  }
+
+  const double elapsed = clock.elapsed_time().as_seconds();
+
+  target.timestamp += fast_forwarded_hours * SecondsInHour;
+  clock.restart();
+
+  model.fast_forward(target);
+
+  const double fast_forward_elapsed = clock.elapsed_time().as_seconds();
+  const uint64_t fast_forwarded_tasks = model.runtime.scheduler_stats.frame_count();
+
+  std::size_t expanded_herds = 0;
+
+  for (const ffw::HerdState& herd : model.state.population.herds) {
+    if (herd.expanded()) {
+      ++expanded_herds;
+    }
+  }
+
+  gf::Log::info("Expansion distance: {}", expansion_distance);
+  gf::Log::info("Simulated {}h in {:g}s ({} hero turns)", simulated_hours, elapsed, hero_turns);
+  gf::Log::info("Fast forwarded {}h in {:g}s ({} tasks)", fast_forwarded_hours, fast_forward_elapsed, fast_forwarded_tasks);
+  gf::Log::info("Herds: {} expanded out of {}", expanded_herds, model.state.population.herds.size());
+  gf::Log::info("Actors: {} ({} scheduled, {} dormant)", model.state.actors.size(), model.state.scheduler.size(), model.state.dormancy.count);
+}
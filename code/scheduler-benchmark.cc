@@ -0,0 +1,142 @@
+#include <cstdint>
+
+#include <queue>
+#include <vector>
+
+#include <gf2/core/Clock.h>
+#include <gf2/core/Log.h>
+#include <gf2/core/Random.h>
+
+#include "bits/SchedulerState.h"
+#include "bits/Times.h"
+
+/*
+ * Micro-benchmark of the scheduler: every actor is rescheduled a few times
+ * with a delay taken from the usual delays of the game.
+ *
+ * Usage: scheduler-benchmark
+ */
+
+namespace {
+
+  constexpr uint32_t ActorCounts[] = { 10'000, 100'000 };
+  constexpr uint32_t TurnsPerActor = 20;
+  constexpr uint64_t RandomSeed = 42;
+
+  constexpr uint16_t Delays[] = { ffw::StraightWalkTime, ffw::DiagonalWalkTime, ffw::GrazeTime, ffw::HeroIdleTime };
+
+  struct TaskComparator {
+    bool operator()(const ffw::Task& lhs, const ffw::Task& rhs) const
+    {
+      return rhs.date < lhs.date;
+    }
+  };
+
+  using PriorityQueue = std::priority_queue<ffw::Task, std::vector<ffw::Task>, TaskComparator>;
+
+  std::vector<ffw::Task> generate_tasks(uint32_t count, gf::Random* random)
+  {
+    std::vector<ffw::Task> tasks;
+    tasks.reserve(count);
+
+    for (uint32_t i = 0; i < count; ++i) {
+      ffw::Date date = {};
+      date.add_seconds(static_cast<uint16_t>(random->compute_uniform_integer(ffw::GrazeTime)));
+      tasks.push_back({ date, ffw::TaskType::Actor, i });
+    }
+
+    return tasks;
+  }
+
+  std::vector<uint16_t> generate_delays(std::size_t count, gf::Random* random)
+  {
+    std::vector<uint16_t> delays;
+    delays.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+      delays.push_back(Delays[random->compute_uniform_integer(std::size(Delays))]);
+    }
+
+    return delays;
+  }
+
+  double benchmark_priority_queue(const std::vector<ffw::Task>& tasks, const std::vector<uint16_t>& delays, uint64_t& checksum)
+  {
+    gf::Clock clock;
+
+    PriorityQueue queue(TaskComparator{}, tasks);
+
+    for (const uint16_t delay : delays) {
+      ffw::Task task = queue.top();
+      queue.pop();
+      task.date.add_seconds(delay);
+      queue.push(task);
+    }
+
+    checksum = queue.top().date.as_seconds();
+    return clock.elapsed_time().as_seconds();
+  }
+
+  double benchmark_pop_push(const std::vector<ffw::Task>& tasks, const std::vector<uint16_t>& delays, uint64_t& checksum)
+  {
+    gf::Clock clock;
+
+    ffw::SchedulerState scheduler;
+
+    for (const ffw::Task& task : tasks) {
+      scheduler.push(task);
+    }
+
+    for (const uint16_t delay : delays) {
+      ffw::Task task = scheduler.top();
+      scheduler.pop();
+      task.date.add_seconds(delay);
+      scheduler.push(task);
+    }
+
+    checksum = scheduler.top().date.as_seconds();
+    return clock.elapsed_time().as_seconds();
+  }
+
+  double benchmark_reschedule_top(const std::vector<ffw::Task>& tasks, const std::vector<uint16_t>& delays, uint64_t& checksum)
+  {
+    gf::Clock clock;
+
+    ffw::SchedulerState scheduler;
+    scheduler.schedule_many(tasks);
+
+    for (const uint16_t delay : delays) {
+      scheduler.reschedule_top(delay);
+    }
+
+    checksum = scheduler.top().date.as_seconds();
+    return clock.elapsed_time().as_seconds();
+  }
+
+}
+
+int main()
+{
+  gf::Random random(RandomSeed);
+
+  for (const uint32_t count : ActorCounts) {
+    const std::vector<ffw::Task> tasks = generate_tasks(count, &random);
+    const std::vector<uint16_t> delays = generate_delays(std::size_t(count) * TurnsPerActor, &random);
+
+    uint64_t checksums[3] = {};
+
+    const double priority_queue_time = benchmark_priority_queue(tasks, delays, checksums[0]);
+    const double pop_push_time = benchmark_pop_push(tasks, delays, checksums[1]);
+    const double reschedule_top_time = benchmark_reschedule_top(tasks, delays, checksums[2]);
+
+    if (checksums[0] != checksums[1] || checksums[0] != checksums[2]) {
+      gf::Log::error("Schedulers disagree for {} actors", count);
+      return 1;
+    }
+
+    gf::Log::info("{} actors, {} turns:", count, delays.size());
+    gf::Log::info("\tstd::priority_queue: {:g}s", priority_queue_time);
+    gf::Log::info("\tpop + push: {:g}s", pop_push_time);
+    gf::Log::info("\tschedule_many + reschedule_top: {:g}s", reschedule_top_time);
+  }
+}
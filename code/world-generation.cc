@@ -1,13 +1,236 @@
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+
 #include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include <gf2/core/Log.h>
 #include <gf2/core/Random.h>
+#include <gf2/core/SerializationAdapter.h>
+#include <gf2/core/SerializationContainer.h>
+#include <gf2/core/SerializationOps.h>
+#include <gf2/core/SerializationUtilities.h>
+#include <gf2/core/Streams.h>
 
 #include "bits/WorldGeneration.h"
 #include "bits/WorldGenerationStep.h"
 
-int main() {
+#include "config.h"
+
+namespace {
+
+  // the seeds of the regression check
+  constexpr uint64_t CheckSeeds[] = {
+    UINT64_C(1),
+    UINT64_C(42),
+    UINT64_C(20250101),
+    UINT64_C(0xfa5fa5fa5fa5fa5f),
+  };
+
+  std::optional<uint64_t> parse_seed(const char* argument)
+  {
+    if (*argument == '\0' || *argument == '-') {
+      return std::nullopt;
+    }
+
+    char* end = nullptr;
+    errno = 0;
+    const uint64_t seed = std::strtoull(argument, &end, 0);
+
+    if (errno != 0 || *end != '\0') {
+      return std::nullopt;
+    }
+
+    return seed;
+  }
+
+  // FNV-1a of the serialized map and network, to check that a seed always gives the same world
+  uint64_t compute_world_hash(const ffw::WorldState& state)
+  {
+    std::vector<uint8_t> bytes;
+    gf::BufferOutputStream stream(&bytes);
+    gf::Serializer ar(&stream, ffw::StateVersion);
+    ar | state.map | state.network;
+
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+
+    for (const uint8_t byte : bytes) {
+      hash = (hash ^ byte) * UINT64_C(0x100000001b3);
+    }
+
+    return hash;
+  }
+
+  std::optional<uint64_t> compute_seed_hash(uint64_t seed)
+  {
+    std::atomic<ffw::WorldGenerationStep> step(ffw::WorldGenerationStep::Start);
+    const std::optional<ffw::WorldState> state = ffw::generate_world(seed, step);
+
+    if (!state) {
+      return std::nullopt;
+    }
+
+    return compute_world_hash(*state);
+  }
+
+  struct RecordedHashes {
+    uint16_t version = 0;
+    std::map<uint64_t, uint64_t> hashes;
+  };
+
+  // a "version N" line, then one "seed hash" line per seed, in hexadecimal, '#' starts a comment
+  RecordedHashes load_hashes(const std::filesystem::path& filename)
+  {
+    RecordedHashes recorded;
+    std::ifstream ifs(filename);
+    std::string line;
+
+    while (std::getline(ifs, line)) {
+      if (line.empty() || line.front() == '#') {
+        continue;
+      }
+
+      std::istringstream iss(line);
+
+      if (line.rfind("version", 0) == 0) {
+        std::string keyword;
+        iss >> keyword >> recorded.version;
+        continue;
+      }
+
+      uint64_t seed = 0;
+      uint64_t hash = 0;
+
+      if (iss >> std::hex >> seed >> hash) {
+        recorded.hashes.emplace(seed, hash);
+      }
+    }
+
+    return recorded;
+  }
+
+  int check_hashes(const std::filesystem::path& filename)
+  {
+    const RecordedHashes recorded = load_hashes(filename);
+
+    // the hash is computed on the serialized state, so it depends on the version of the serialization
+    if (recorded.version != ffw::StateVersion) {
+      gf::Log::error("The hashes in {} are for version {}, record them again for version {}", filename.string(), recorded.version, ffw::StateVersion);
+      return EXIT_FAILURE;
+    }
+
+    const std::map<uint64_t, uint64_t>& expected_hashes = recorded.hashes;
+    int failures = 0;
+
+    for (const uint64_t seed : CheckSeeds) {
+      const std::optional<uint64_t> hash = compute_seed_hash(seed);
+
+      if (!hash) {
+        gf::Log::error("Seed {:016x}: no world generated", seed);
+        ++failures;
+      } else if (auto iterator = expected_hashes.find(seed); iterator == expected_hashes.end()) {
+        gf::Log::error("Seed {:016x}: no hash recorded in {}", seed, filename.string());
+        ++failures;
+      } else if (iterator->second != *hash) {
+        gf::Log::error("Seed {:016x}: hash {:016x}, expected {:016x}", seed, *hash, iterator->second);
+        ++failures;
+      } else {
+        gf::Log::info("Seed {:016x}: ok", seed);
+      }
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  int record_hashes(const std::filesystem::path& filename)
+  {
+    std::ofstream ofs(filename);
+
+    if (!ofs) {
+      gf::Log::error("Could not write {}", filename.string());
+      return EXIT_FAILURE;
+    }
+
+    ofs << "# recorded with: world-generation --record\n";
+    ofs << "# the hashes depend on StateVersion, record them again when it changes\n";
+    ofs << "version " << ffw::StateVersion << '\n';
+    ofs << "# seed hash\n";
+
+    for (const uint64_t seed : CheckSeeds) {
+      const std::optional<uint64_t> hash = compute_seed_hash(seed);
+
+      if (!hash) {
+        gf::Log::error("Seed {:016x}: no world generated", seed);
+        return EXIT_FAILURE;
+      }
+
+      ofs << std::hex << seed << ' ' << *hash << '\n';
+      gf::Log::info("Seed {:016x}: {:016x}", seed, *hash);
+    }
+
+    return EXIT_SUCCESS;
+  }
+
+  int generate_one(uint64_t seed)
+  {
+    std::atomic<ffw::WorldGenerationStep> step(ffw::WorldGenerationStep::Start);
+
+    ffw::WorldGenerationSettings settings;
+    settings.debug_images = true;
+
+    ffw::WorldGenerationStats stats;
+    const std::optional<ffw::WorldState> state = ffw::generate_world(seed, step, settings, &stats);
+
+    gf::Log::info("Terrains: {}", stats.terrains);
+    gf::Log::info("Towns: {} candidates, {} rejected, {} rounds", stats.towns.candidates, stats.towns.rejections, stats.towns.rounds);
+    gf::Log::info("Localities: {} candidates, {} rejected, {} rounds", stats.localities.candidates, stats.localities.rejections, stats.localities.rounds);
+
+    if (!state) {
+      return EXIT_FAILURE;
+    }
+
+    gf::Log::info("Seed: {}, hash: {:016x}", state->seed, compute_world_hash(*state));
+    return EXIT_SUCCESS;
+  }
+
+}
+
+/*
+ * world-generation [seed]       generate a world, with the debug images
+ * world-generation --check      compare the hashes of the check seeds with the recorded ones
+ * world-generation --record     record the hashes of the check seeds
+ */
+
+int main(int argc, char* argv[]) {
+  const std::filesystem::path hashes_file(ffw::WorldGenerationHashesFile);
+
+  if (argc > 1) {
+    const std::string_view argument = argv[1];
+
+    if (argument == "--check") {
+      return check_hashes(hashes_file);
+    }
+
+    if (argument == "--record") {
+      return record_hashes(hashes_file);
+    }
+
+    if (const std::optional<uint64_t> seed = parse_seed(argv[1]); seed) {
+      return generate_one(*seed);
+    }
+
+    gf::Log::error("Invalid seed: '{}'", argument);
+    return EXIT_FAILURE;
+  }
+
   gf::Random random;
-  std::atomic<ffw::WorldGenerationStep> step(ffw::WorldGenerationStep::Start);
-  ffw::generate_world(&random, step);
+  return generate_one(ffw::generate_world_seed(&random));
 }
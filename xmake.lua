@@ -8,6 +8,10 @@ add_requires("gamedevframework2", "nlohmann_json")
 add_rules("mode.debug", "mode.releasedbg", "mode.release")
 add_rules("plugin.compile_commands.autoupdate", {outputdir = "$(builddir)"})
 
+if is_mode("debug", "sanitizers") then
+    add_defines("FFW_DEBUG_LOG")
+end
+
 if is_mode("sanitizers") then
     set_symbols("debug")
     set_optimize("none")
@@ -27,6 +31,7 @@ end
 
 set_configdir("$(builddir)/config")
 set_configvar("FARFARWEST_DATADIR", "$(projectdir)/data/farfarwest")
+set_configvar("FARFARWEST_HASHESFILE", "$(projectdir)/data/world-generation/hashes.txt")
 add_configfiles("code/config.h.in", {pattern = "@(.-)@"})
 
 target("farfarwest")
@@ -41,12 +46,29 @@ target("world-generation")
     set_kind("binary")
     add_files("code/world-generation.cc")
     add_files("code/bits/Date.cc")
+    add_files("code/bits/Logging.cc")
     add_files("code/bits/Names.cc")
+    add_files("code/bits/Parallel.cc")
     add_files("code/bits/*State.cc")
     add_files("code/bits/WorldGeneration.cc")
+    add_includedirs("$(builddir)/config")
+    add_packages("gamedevframework2", "nlohmann_json")
+    set_rundir("$(projectdir)/run")
+
+target("population-benchmark")
+    set_kind("binary")
+    add_files("code/population-benchmark.cc")
+    add_files("code/bits/*.cc")
+    add_includedirs("$(builddir)/config")
     add_packages("gamedevframework2", "nlohmann_json")
     set_rundir("$(projectdir)/run")
 
+target("scheduler-benchmark")
+    set_kind("binary")
+    add_files("code/scheduler-benchmark.cc")
+    add_files("code/bits/SchedulerState.cc")
+    add_packages("gamedevframework2")
+
 target("name-generation")
     set_kind("binary")
     add_files("code/name-generation.cc")